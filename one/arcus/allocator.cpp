@@ -1,6 +1,8 @@
 #include <one/arcus/allocator.h>
 
 #include <assert.h>
+#include <atomic>
+#include <cstddef>
 #include <cstdlib>
 
 namespace i3d {
@@ -31,6 +33,69 @@ std::function<void *(size_t)> _alloc = default_alloc;
 std::function<void(void *)> _free = default_free;
 std::function<void *(void *, size_t)> _realloc = default_realloc;
 
+namespace {
+
+bool _is_instrumented = false;
+
+// Subsystem of the innermost ScopedSubsystem of the thread.
+thread_local Subsystem _subsystem = Subsystem::other;
+
+struct AtomicStats {
+    std::atomic<size_t> allocations;
+    std::atomic<size_t> frees;
+    std::atomic<size_t> allocated_bytes;
+    std::atomic<size_t> bytes;
+    std::atomic<size_t> peak_bytes;
+};
+
+AtomicStats _stats[static_cast<size_t>(Subsystem::count)];
+
+// Prefixed to instrumented memory, so that frees can be attributed. Keeps the
+// memory following it aligned for any type.
+struct alignas(std::max_align_t) Header {
+    size_t size;
+    Subsystem subsystem;
+};
+
+void count_allocation(AtomicStats &stats, size_t bytes) {
+    ++stats.allocations;
+    stats.allocated_bytes += bytes;
+    const size_t current = (stats.bytes += bytes);
+    size_t peak = stats.peak_bytes;
+    while (peak < current && !stats.peak_bytes.compare_exchange_weak(peak, current)) {
+    }
+}
+
+void count_free(AtomicStats &stats, size_t bytes) {
+    ++stats.frees;
+    stats.bytes -= bytes;
+}
+
+// Writes the header at the start of p, returning the memory following it.
+void *track(void *p, size_t bytes) {
+    if (p == nullptr) {
+        return nullptr;
+    }
+
+    Header *header = static_cast<Header *>(p);
+    header->size = bytes;
+    header->subsystem = _subsystem;
+    count_allocation(_stats[static_cast<size_t>(header->subsystem)], bytes);
+    count_allocation(_stats[static_cast<size_t>(Subsystem::all)], bytes);
+    return header + 1;
+}
+
+void untrack(const Header &header) {
+    count_free(_stats[static_cast<size_t>(header.subsystem)], header.size);
+    count_free(_stats[static_cast<size_t>(Subsystem::all)], header.size);
+}
+
+Header *header_of(void *p) {
+    return static_cast<Header *>(p) - 1;
+}
+
+}  // namespace
+
 void set_alloc(std::function<void *(size_t)> fn) {
     _alloc = fn;
 }
@@ -49,8 +114,46 @@ void reset_overrides() {
     _realloc = default_realloc;
 }
 
+void set_instrumentation(bool is_enabled) {
+    _is_instrumented = is_enabled;
+}
+
+bool is_instrumentation_enabled() {
+    return _is_instrumented;
+}
+
+Stats stats(Subsystem subsystem) {
+    assert(subsystem < Subsystem::count);
+    const AtomicStats &stats = _stats[static_cast<size_t>(subsystem)];
+    return Stats{stats.allocations, stats.frees, stats.allocated_bytes, stats.bytes,
+                 stats.peak_bytes};
+}
+
+void reset_stats() {
+    for (auto &stats : _stats) {
+        stats.allocations = 0;
+        stats.frees = 0;
+        stats.allocated_bytes = 0;
+        stats.peak_bytes = stats.bytes.load();
+    }
+}
+
+ScopedSubsystem::ScopedSubsystem(Subsystem subsystem) : _previous(_subsystem) {
+    _subsystem = subsystem;
+}
+
+ScopedSubsystem::~ScopedSubsystem() {
+    _subsystem = _previous;
+}
+
 void *alloc(size_t bytes) {
     assert(_alloc);
+    if (_is_instrumented) {
+        void *p = track(_alloc(sizeof(Header) + bytes), bytes);
+        assert(p != nullptr);
+        return p;
+    }
+
     void *p = _alloc(bytes);
     assert(p != nullptr);
     return p;
@@ -58,10 +161,31 @@ void *alloc(size_t bytes) {
 
 void free(void *p) {
     assert(_free);
+    if (_is_instrumented && p != nullptr) {
+        Header *header = header_of(p);
+        untrack(*header);
+        _free(header);
+        return;
+    }
+
     _free(p);
 }
 
 void *realloc(void *p, size_t s) {
+    if (_is_instrumented) {
+        // On failure the original memory is left as is, still counted.
+        Header *original = (p != nullptr) ? header_of(p) : nullptr;
+        const Header original_header = (p != nullptr) ? *original : Header{0, _subsystem};
+        void *reallocated = _realloc(original, sizeof(Header) + s);
+        if (reallocated == nullptr) {
+            return nullptr;
+        }
+        if (p != nullptr) {
+            untrack(original_header);
+        }
+        return track(reallocated, s);
+    }
+
     return _realloc(p, s);
 }
 
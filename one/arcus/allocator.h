@@ -25,6 +25,58 @@ void set_realloc(std::function<void *(void *, size_t)>);
 // Sets the allocators back to the default.
 void reset_overrides();
 
+//-----------------
+// Instrumentation.
+
+// The parts of the SDK that allocations are attributed to, see
+// ScopedSubsystem. The values match OneAllocationSubsystem.
+enum class Subsystem {
+    other = 0,
+    codec,       // Message encoding and decoding.
+    connection,  // Connection buffers and queues.
+    payload,     // JSON documents of payloads, arrays and objects.
+    c_api,       // Handles created through the C API.
+    all,         // All of the above together.
+    count
+};
+
+struct Stats {
+    size_t allocations;      // Including reallocations.
+    size_t frees;            // Including reallocations.
+    size_t allocated_bytes;  // Total requested by the allocations.
+    size_t bytes;            // Currently allocated.
+    size_t peak_bytes;       // Highest value of bytes.
+};
+
+// Enables counting the allocations per subsystem. Instrumented memory carries
+// a header, so like the overrides this must be set at init time, before any
+// memory is allocated through this namespace, or once all of it is freed.
+void set_instrumentation(bool is_enabled);
+bool is_instrumentation_enabled();
+
+// Returns the counts of the subsystem since instrumentation was enabled or
+// reset_stats was called. Thread-safe.
+Stats stats(Subsystem subsystem);
+
+// Resets the counts of all subsystems, except for the currently allocated
+// bytes, which also become the peak. Thread-safe.
+void reset_stats();
+
+// Attributes the allocations made on the calling thread to the subsystem
+// while it is in scope. The innermost scope wins. Allocations outside of any
+// scope are attributed to Subsystem::other.
+class ScopedSubsystem final {
+public:
+    explicit ScopedSubsystem(Subsystem subsystem);
+    ~ScopedSubsystem();
+
+private:
+    ScopedSubsystem(const ScopedSubsystem &) = delete;
+    ScopedSubsystem &operator=(const ScopedSubsystem &) = delete;
+
+    Subsystem _previous;
+};
+
 // Use the function set by set_alloc to allocate memory.
 void *alloc(size_t);
 
@@ -44,8 +96,12 @@ T *create(Args &&... args) {
 }
 
 // Equivalent to the delete operator, but using the function set by set_free.
+// Like delete, does nothing if p is null.
 template <class T>
 void destroy(T *p) noexcept {
+    if (p == nullptr) {
+        return;
+    }
     p->~T();
     free(p);
 }
@@ -3,32 +3,68 @@
 #include <one/arcus/internal/rapidjson/writer.h>
 #include <one/arcus/object.h>
 
+#include <utility>
+
 namespace i3d {
 namespace one {
 
-Array::Array() : _doc(rapidjson::kArrayType) {}
+Array::Array()
+    : _doc(rapidjson::kArrayType, &_arena, arena_document_stack_capacity, &_arena) {}
 
-Array::Array(const Array &other) {
+Array::Array(const Array &other)
+    : _doc(rapidjson::kArrayType, &_arena, arena_document_stack_capacity, &_arena) {
     _doc.CopyFrom(other.get(), _doc.GetAllocator());
 }
 
+Array::Array(Array &&other)
+    : _doc(rapidjson::kArrayType, &_arena, arena_document_stack_capacity, &_arena) {
+    *this = std::move(other);
+}
+
 Array &Array::operator=(const Array &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // The whole document is replaced, reuse its memory.
+    _doc.SetArray();
+    _arena.reset();
     _doc.CopyFrom(other.get(), _doc.GetAllocator());
     return *this;
 }
 
+Array &Array::operator=(Array &&other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // Exchange the memory and the values, each document keeps allocating
+    // from the arena it owns.
+    _arena.swap(other._arena);
+    static_cast<rapidjson::Value &>(_doc).Swap(other._doc);
+    other._doc.SetArray();
+    other._arena.reset();
+    return *this;
+}
+
 OneError Array::set(const rapidjson::Value &array) {
     if (!array.IsArray()) {
         return ONE_ERROR_ARRAY_WRONG_TYPE_IS_EXPECTING_ARRAY;
     }
 
-    _doc.Clear();
+    // The whole document is replaced, reuse its memory.
+    _doc.SetArray();
+    _arena.reset();
     _doc.CopyFrom(array, _doc.GetAllocator());
     return ONE_ERROR_NONE;
 }
 
 void Array::clear() {
-    _doc.Clear();
+    // Reuse the memory of the whole document, but keep the capacity.
+    const auto capacity = _doc.Capacity();
+    _doc.SetArray();
+    _arena.reset();
+    _doc.Reserve(capacity, _doc.GetAllocator());
 }
 
 void Array::reserve(size_t size) {
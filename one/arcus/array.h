@@ -1,6 +1,7 @@
 #pragma once
 
 #include <one/arcus/error.h>
+#include <one/arcus/internal/arena.h>
 #include <one/arcus/internal/rapidjson/document.h>
 #include <one/arcus/types.h>
 
@@ -19,7 +20,10 @@ class Array final {
 public:
     Array();
     Array(const Array &other);
+    Array(Array &&other);
     Array &operator=(const Array &other);
+    // Takes over the document of the other array, which is left empty.
+    Array &operator=(Array &&other);
     ~Array() = default;
 
     OneError set(const rapidjson::Value &array);
@@ -65,6 +69,7 @@ public:
     OneError set_val_object(unsigned int pos, const Object &val);
 
 private:
+    Arena _arena;  // Memory of _doc.
     rapidjson::Document _doc;
 };
 
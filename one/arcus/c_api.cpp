@@ -3,6 +3,7 @@
 #include <one/arcus/allocator.h>
 #include <one/arcus/array.h>
 #include <one/arcus/error.h>
+#include <one/arcus/internal/pool.h>
 #include <one/arcus/logger.h>
 #include <one/arcus/message.h>
 #include <one/arcus/object.h>
@@ -18,12 +19,32 @@ namespace i3d {
 namespace one {
 namespace {
 
+// Arrays and objects destroyed through the C API are kept here for reuse, up
+// to the capacity set via one_array_pool_set_capacity and
+// one_object_pool_set_capacity.
+//
+// The pools are leaked on purpose. Destroying them at exit would free the kept
+// instances through the free override current at that time, which may differ
+// from the one they were allocated with, or belong to an allocator that is
+// already gone. The pool objects themselves hold no memory from the overrides
+// once their capacity is 0.
+Pool<Array> &array_pool() {
+    static Pool<Array> *pool = new Pool<Array>();
+    return *pool;
+}
+
+Pool<Object> &object_pool() {
+    static Pool<Object> *pool = new Pool<Object>();
+    return *pool;
+}
+
 OneError array_create(OneArrayPtr *array) {
     if (array == nullptr) {
         return ONE_ERROR_VALIDATION_ARRAY_IS_NULLPTR;
     }
 
-    auto a = allocator::create<Array>();
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::c_api);
+    auto a = array_pool().acquire();
     if (a == nullptr) {
         return ONE_ERROR_ARRAY_ALLOCATION_FAILED;
     }
@@ -38,7 +59,11 @@ void array_destroy(OneArrayPtr array) {
     }
 
     auto a = (Array *)(array);
-    allocator::destroy<Array>(a);
+    array_pool().release(a);
+}
+
+void array_pool_set_capacity(unsigned int capacity) {
+    array_pool().set_capacity(capacity);
 }
 
 OneError array_copy(OneArrayPtr source, OneArrayPtr destination) {
@@ -434,7 +459,8 @@ OneError object_create(OneObjectPtr *object) {
         return ONE_ERROR_VALIDATION_OBJECT_IS_NULLPTR;
     }
 
-    auto o = allocator::create<Object>();
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::c_api);
+    auto o = object_pool().acquire();
     if (o == nullptr) {
         return ONE_ERROR_OBJECT_ALLOCATION_FAILED;
     }
@@ -449,7 +475,11 @@ void object_destroy(OneObjectPtr object) {
     }
 
     auto o = reinterpret_cast<Object *>(object);
-    allocator::destroy<Object>(o);
+    object_pool().release(o);
+}
+
+void object_pool_set_capacity(unsigned int capacity) {
+    object_pool().set_capacity(capacity);
 }
 
 OneError object_copy(OneObjectPtr source, OneObjectPtr destination) {
@@ -779,17 +809,19 @@ OneError object_set_val_object(OneObjectPtr object, const char *key, OneObjectPt
     return o->set_val_object(key, *v);
 }
 
-OneError server_create(unsigned int port, OneServerPtr *server) {
+OneError server_create(unsigned int port, Server::Threading threading,
+                       OneServerPtr *server) {
     if (server == nullptr) {
         return ONE_ERROR_VALIDATION_SERVER_IS_NULLPTR;
     }
 
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::c_api);
     auto s = allocator::create<Server>();
     if (s == nullptr) {
         return ONE_ERROR_SERVER_ALLOCATION_FAILED;
     }
 
-    auto err = s->init(port);
+    auto err = s->init(port, threading);
     if (is_error(err)) {
         allocator::destroy<Server>(s);
         return err;
@@ -846,6 +878,37 @@ OneError server_status(OneServerPtr const server, OneServerStatus *status) {
     return ONE_ERROR_NONE;
 }
 
+OneError server_stats(OneServerPtr const server, OneServerStats *stats) {
+    auto s = (Server *)server;
+    if (s == nullptr) {
+        return ONE_ERROR_VALIDATION_SERVER_IS_NULLPTR;
+    }
+
+    if (stats == nullptr) {
+        return ONE_ERROR_VALIDATION_STATS_IS_NULLPTR;
+    }
+
+    Server::Stats server_stats;
+    const auto err = s->stats(server_stats);
+    if (is_error(err)) {
+        return err;
+    }
+
+    stats->messages_in = server_stats.messages_in;
+    stats->messages_out = server_stats.messages_out;
+    stats->bytes_in = server_stats.bytes_in;
+    stats->bytes_out = server_stats.bytes_out;
+    stats->update_time = server_stats.update_time;
+    stats->io_time = server_stats.io_time;
+    stats->connection_time = server_stats.connection_time;
+    stats->encode_time = server_stats.encode_time;
+    stats->decode_time = server_stats.decode_time;
+    stats->dispatch_time = server_stats.dispatch_time;
+    stats->incoming_queue_peak = server_stats.incoming_queue_peak;
+    stats->outgoing_queue_peak = server_stats.outgoing_queue_peak;
+    return ONE_ERROR_NONE;
+}
+
 OneError server_set_live_state(OneServerPtr server, int players, int max_players,
                                const char *name, const char *map, const char *mode,
                                const char *version, OneObjectPtr additional_data) {
@@ -878,6 +941,26 @@ OneError server_set_live_state(OneServerPtr server, int players, int max_players
     return s->set_live_state(players, max_players, name, map, mode, version, object);
 }
 
+OneError server_set_live_state_coalescing(OneServerPtr server, unsigned int window_ms,
+                                          unsigned int max_delay_ms) {
+    auto s = reinterpret_cast<Server *>(server);
+    if (s == nullptr) {
+        return ONE_ERROR_VALIDATION_SERVER_IS_NULLPTR;
+    }
+
+    return s->set_live_state_coalescing(window_ms, max_delay_ms);
+}
+
+OneError server_set_binary_payloads(OneServerPtr server, bool is_enabled) {
+    auto s = reinterpret_cast<Server *>(server);
+    if (s == nullptr) {
+        return ONE_ERROR_VALIDATION_SERVER_IS_NULLPTR;
+    }
+
+    s->set_binary_payloads(is_enabled);
+    return ONE_ERROR_NONE;
+}
+
 OneError server_send_reverse_metadata(OneServerPtr server, OneArrayPtr data) {
     auto s = reinterpret_cast<Server *>(server);
     if (s == nullptr) {
@@ -1015,6 +1098,27 @@ void allocator_set_realloc(void *(*callback)(void *, unsigned int size)) {
     allocator::set_realloc(wrapper);
 }
 
+static_assert(static_cast<int>(allocator::Subsystem::all) == ONE_ALLOCATION_SUBSYSTEM_ALL,
+              "allocation subsystems must match");
+
+OneError allocator_stats(OneAllocationSubsystem subsystem, OneAllocationStats *stats) {
+    if (stats == nullptr) {
+        return ONE_ERROR_VALIDATION_STATS_IS_NULLPTR;
+    }
+    if (subsystem < ONE_ALLOCATION_SUBSYSTEM_OTHER ||
+        ONE_ALLOCATION_SUBSYSTEM_ALL < subsystem) {
+        return ONE_ERROR_VALIDATION_SUBSYSTEM_IS_INVALID;
+    }
+
+    const auto s = allocator::stats(static_cast<allocator::Subsystem>(subsystem));
+    stats->allocations = s.allocations;
+    stats->frees = s.frees;
+    stats->allocated_bytes = s.allocated_bytes;
+    stats->bytes = s.bytes;
+    stats->peak_bytes = s.peak_bytes;
+    return ONE_ERROR_NONE;
+}
+
 }  // Unnamed namespace.
 }  // namespace one
 }  // namespace i3d
@@ -1031,6 +1135,10 @@ void one_array_destroy(OneArrayPtr array) {
     return one::array_destroy(array);
 }
 
+void one_array_pool_set_capacity(unsigned int capacity) {
+    one::array_pool_set_capacity(capacity);
+}
+
 OneError one_array_copy(OneArrayPtr source, OneArrayPtr destination) {
     return one::array_copy(source, destination);
 }
@@ -1153,6 +1261,10 @@ void one_object_destroy(OneObjectPtr object) {
     one::object_destroy(object);
 }
 
+void one_object_pool_set_capacity(unsigned int capacity) {
+    one::object_pool_set_capacity(capacity);
+}
+
 OneError one_object_copy(OneObjectPtr source, OneObjectPtr destination) {
     return one::object_copy(source, destination);
 }
@@ -1230,7 +1342,11 @@ OneError one_object_set_val_object(OneObjectPtr object, const char *key,
 }
 
 OneError one_server_create(unsigned int port, OneServerPtr *server) {
-    return one::server_create(port, server);
+    return one::server_create(port, one::Server::Threading::game_thread, server);
+}
+
+OneError one_server_create_with_io_thread(unsigned int port, OneServerPtr *server) {
+    return one::server_create(port, one::Server::Threading::io_thread, server);
 }
 
 OneError one_server_set_logger(OneServerPtr server, OneLogFn log_cb, void *userdata) {
@@ -1249,6 +1365,10 @@ OneError one_server_status(OneServerPtr const server, OneServerStatus *status) {
     return one::server_status(server, status);
 }
 
+OneError one_server_stats(OneServerPtr const server, OneServerStats *stats) {
+    return one::server_stats(server, stats);
+}
+
 OneError one_server_set_live_state(OneServerPtr server, int players, int max_players,
                                    const char *name, const char *map, const char *mode,
                                    const char *version, OneObjectPtr additional_data) {
@@ -1256,6 +1376,15 @@ OneError one_server_set_live_state(OneServerPtr server, int players, int max_pla
                                       version, additional_data);
 }
 
+OneError one_server_set_live_state_coalescing(OneServerPtr server, unsigned int window_ms,
+                                             unsigned int max_delay_ms) {
+    return one::server_set_live_state_coalescing(server, window_ms, max_delay_ms);
+}
+
+OneError one_server_set_binary_payloads(OneServerPtr server, bool is_enabled) {
+    return one::server_set_binary_payloads(server, is_enabled);
+}
+
 OneError one_server_send_reverse_metadata(OneServerPtr server, OneArrayPtr data) {
     return one::server_send_reverse_metadata(server, data);
 }
@@ -1312,4 +1441,16 @@ void one_allocator_set_realloc(void *(*callback)(void *, unsigned int size)) {
     one::allocator_set_realloc(callback);
 }
 
+void one_allocator_set_instrumentation(bool is_enabled) {
+    one::allocator::set_instrumentation(is_enabled);
+}
+
+OneError one_allocator_stats(OneAllocationSubsystem subsystem, OneAllocationStats *stats) {
+    return one::allocator_stats(subsystem, stats);
+}
+
+void one_allocator_reset_stats() {
+    one::allocator::reset_stats();
+}
+
 };  // extern "C"
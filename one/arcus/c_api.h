@@ -107,6 +107,48 @@ ONE_EXPORT void one_allocator_set_free(void (*callback)(void *));
 /// the standard c realloc requirements for behavior.
 ONE_EXPORT void one_allocator_set_realloc(void *(*callback)(void *, unsigned int size));
 
+/// The parts of the SDK that allocations are attributed to by the allocation
+/// instrumentation.
+/// \sa one_allocator_stats
+typedef enum OneAllocationSubsystem {
+    ONE_ALLOCATION_SUBSYSTEM_OTHER = 0,
+    ONE_ALLOCATION_SUBSYSTEM_CODEC,       ///< Message encoding and decoding.
+    ONE_ALLOCATION_SUBSYSTEM_CONNECTION,  ///< Connection buffers and queues.
+    ONE_ALLOCATION_SUBSYSTEM_PAYLOAD,     ///< Message, array and object data.
+    ONE_ALLOCATION_SUBSYSTEM_C_API,       ///< Handles created by this API.
+    ONE_ALLOCATION_SUBSYSTEM_ALL          ///< All of the above together.
+} OneAllocationSubsystem;
+
+/// Allocation counts of a subsystem.
+typedef struct OneAllocationStats {
+    unsigned long long allocations;      ///< Including reallocations.
+    unsigned long long frees;            ///< Including reallocations.
+    unsigned long long allocated_bytes;  ///< Total requested by the allocations.
+    unsigned long long bytes;            ///< Currently allocated.
+    unsigned long long peak_bytes;       ///< Highest value of bytes.
+} OneAllocationStats;
+
+/// Optional allocation instrumentation, off by default. If enabled, the
+/// allocations made by the SDK are counted per subsystem, which allows
+/// checking that no allocations are made in a steady state. Each allocation
+/// is a few bytes larger when enabled. Like the allocator overrides, it must be
+/// set at init time, before using any other APIs, and may only be disabled
+/// once all SDK objects are destroyed.
+/// @param is_enabled Whether to count the allocations.
+/// @sa one_allocator_stats
+ONE_EXPORT void one_allocator_set_instrumentation(bool is_enabled);
+
+/// Gets the allocation counts of a subsystem since the instrumentation was
+/// enabled or one_allocator_reset_stats was called. Thread-safe.
+/// @param subsystem The subsystem to get the counts of.
+/// @param stats A non-null pointer to the counts to set.
+ONE_EXPORT OneError one_allocator_stats(OneAllocationSubsystem subsystem,
+                                        OneAllocationStats *stats);
+
+/// Resets the allocation counts of all subsystems, except for the currently
+/// allocated bytes, which also become the peak. Thread-safe.
+ONE_EXPORT void one_allocator_reset_stats();
+
 //------------------------------------------------------------------------------
 ///@}
 ///@name Server interface.
@@ -138,6 +180,17 @@ typedef enum OneLogLevel { ONE_LOG_LEVEL_INFO = 0, ONE_LOG_LEVEL_ERROR } OneLogL
 /// \sa one_server_status
 ONE_EXPORT OneError one_server_create(unsigned int port, OneServerPtr *server);
 
+/// Same as one_server_create, but the server owns a background thread that
+/// does the socket I/O and the encoding and decoding of messages. Calls to
+/// one_server_update then only call the incoming message callbacks, which are
+/// still called on the thread calling one_server_update. The log callback, if
+/// set, is also called from the background thread.
+/// @param port The port to bind to and listen on for incoming Client connections.
+/// @param server A null server pointer, which will be set to a new server.
+/// \sa one_server_create
+ONE_EXPORT OneError one_server_create_with_io_thread(unsigned int port,
+                                                     OneServerPtr *server);
+
 /// Log callback function to allow the integration to handle internal ONE Server
 /// logs with its own logger.
 /// @param userdata Optional user data that will be passed back to the callback.
@@ -177,6 +230,31 @@ ONE_EXPORT OneError one_server_update(OneServerPtr server);
 /// @param status A pointer to a status enum value to be set.
 ONE_EXPORT OneError one_server_status(OneServerPtr const server, OneServerStatus *status);
 
+/// Counters of the server's hot paths since it was created. They are not reset
+/// by a shutdown or a later init. Times are the total nanoseconds spent,
+/// measured with a monotonic clock.
+typedef struct OneServerStats {
+    unsigned long long messages_in;          ///< Including handshake and health.
+    unsigned long long messages_out;         ///< Including handshake and health.
+    unsigned long long bytes_in;             ///< Received from the socket.
+    unsigned long long bytes_out;            ///< Sent to the socket.
+    unsigned long long update_time;          ///< In one_server_update.
+    unsigned long long io_time;              ///< Socket and connection updates.
+    unsigned long long connection_time;      ///< Connection updates, part of io.
+    unsigned long long encode_time;          ///< Encoding, part of connection.
+    unsigned long long decode_time;          ///< Decoding, part of connection.
+    unsigned long long dispatch_time;        ///< In message callbacks.
+    unsigned long long incoming_queue_peak;  ///< Most queued incoming messages.
+    unsigned long long outgoing_queue_peak;  ///< Most queued outgoing messages.
+} OneServerStats;
+
+/// Gets the counters of the server's hot paths, to monitor its overhead in
+/// production. Thread-safe, and cheap enough to call every update. Fails with
+/// ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED while the server is not initialized.
+/// @param server A non-null server pointer.
+/// @param stats A non-null pointer to the counters to set.
+ONE_EXPORT OneError one_server_stats(OneServerPtr const server, OneServerStats *stats);
+
 //------------------------------------------------------------------------------
 ///@}
 ///@name Array main interface
@@ -190,6 +268,15 @@ ONE_EXPORT OneError one_array_create(OneArrayPtr *array);
 /// @param array A non-null OneArrayPtr, to be deleted.
 ONE_EXPORT void one_array_destroy(OneArrayPtr array);
 
+/// Sets how many destroyed arrays are kept, together with their memory, to be
+/// reused by one_array_create. Creating and destroying arrays then does not
+/// allocate once warm. Defaults to 0. Lowering it frees the arrays above the
+/// new capacity. Kept arrays are not freed at exit, set it to 0 to free
+/// them, e.g. before shutting down and while the allocator overrides they were
+/// allocated with are still set. Thread-safe.
+/// @param capacity The maximum number of arrays kept.
+ONE_EXPORT void one_array_pool_set_capacity(unsigned int capacity);
+
 /// Makes a copy of the array. The destination must have been created via
 /// one_array_create.
 /// @param source A pointer that will be copied into the destination.
@@ -332,6 +419,15 @@ ONE_EXPORT OneError one_object_create(OneObjectPtr *object);
 /// @param object A non-null object pointer created via one_object_create.
 ONE_EXPORT void one_object_destroy(OneObjectPtr object);
 
+/// Sets how many destroyed objects are kept, together with their memory, to be
+/// reused by one_object_create. Creating and destroying objects then does not
+/// allocate once warm. Defaults to 0. Lowering it frees the objects above the
+/// new capacity. Kept objects are not freed at exit, set it to 0 to free
+/// them, e.g. before shutting down and while the allocator overrides they were
+/// allocated with are still set. Thread-safe.
+/// @param capacity The maximum number of objects kept.
+ONE_EXPORT void one_object_pool_set_capacity(unsigned int capacity);
+
 /// Makes a copy of the object. The destination must have been created via
 /// one_object_create.
 /// @param source A pointer that will be copied into the destination.
@@ -432,7 +528,9 @@ ONE_EXPORT OneError one_object_set_val_object(OneObjectPtr object, const char *k
 /// Set the live game state information about the game server. This should be
 /// called at the least when the state changes, but it is safe to call more
 /// often if it is more convenient to do so - data is only sent out if there are
-/// changes from the previous call. Thread-safe.
+/// changes from the previous call. Thread-safe. The state is queued for the
+/// next one_server_update without waiting for it. If the server is not updated
+/// often enough for the queue to drain, only the latest state is kept.
 /// @param server A non-null server pointer.
 /// @param players Current player count.
 /// @param max_players Max player count allowed in current match.
@@ -447,9 +545,36 @@ ONE_EXPORT OneError one_server_set_live_state(OneServerPtr server, int players,
                                               const char *version,
                                               OneObjectPtr additional_data);
 
+/// Coalesces live states that are set in quick succession, e.g. when the
+/// player count churns, to reduce the number of live state messages sent. A
+/// change is only sent once no new change was set for the window, so that only
+/// the latest state of a burst is sent, but no later than the max delay after
+/// the first unsent change. By default the window is 0, which sends each
+/// change on the next one_server_update. Thread-safe.
+/// @param server A non-null server pointer.
+/// @param window_ms The quiet time, in milliseconds, to wait for further
+/// changes. 0 disables coalescing.
+/// @param max_delay_ms The maximum time, in milliseconds, a change is held
+/// back. Must be at least window_ms, otherwise
+/// ONE_ERROR_SERVER_INVALID_LIVE_STATE_COALESCING is returned.
+ONE_EXPORT OneError one_server_set_live_state_coalescing(OneServerPtr server,
+                                                         unsigned int window_ms,
+                                                         unsigned int max_delay_ms);
+
+/// Use a compact binary encoding instead of JSON for message payloads, if the
+/// connecting Arcus client supports it. Off by default. Only enable it if the
+/// agent runs an SDK version that supports binary payloads, as older ones fail
+/// the handshake. Applies from the next client connection. Thread-safe.
+/// @param server A non-null server pointer.
+/// @param is_enabled Whether to advertise binary payloads.
+ONE_EXPORT OneError one_server_set_binary_payloads(OneServerPtr server, bool is_enabled);
+
 /// Send the reverse metadata message to the ONE Platform. This should be
 /// called when needed to send user defined metadata back to the ONE Platform.
-/// Thread-safe.
+/// Thread-safe. The message is queued for the next one_server_update without
+/// waiting for it. Fails with ONE_ERROR_SERVER_CONNECTION_NOT_READY if no
+/// Client is connected, and with ONE_ERROR_SERVER_PROPERTY_QUEUE_FULL if more
+/// messages are sent between two one_server_update calls than can be queued.
 /// @param server A non-null server pointer.
 /// @param data Any key/value pairs set on this object will be added.
 ONE_EXPORT OneError one_server_send_reverse_metadata(OneServerPtr server,
@@ -457,7 +582,9 @@ ONE_EXPORT OneError one_server_send_reverse_metadata(OneServerPtr server,
 
 /// This should be called at the least when the state changes, but it is safe to
 /// call more often if it is more convenient to do so - data is only sent out if
-/// there are changes from the previous call. Thread-safe.
+/// there are changes from the previous call. Thread-safe. The status is queued
+/// for the next one_server_update without waiting for it. If the server is not
+/// updated often enough for the queue to drain, only the latest status is kept.
 /// @param server A non-null server pointer.
 /// @param status The current status of the game server application instance.
 ONE_EXPORT OneError one_server_set_application_instance_status(
@@ -31,6 +31,8 @@ typedef enum OneError {
     ONE_ERROR_CODEC_INVALID_MESSAGE_PAYLOAD_SIZE_TOO_BIG = 305,
     ONE_ERROR_CODEC_INVALID_HEADER = 306,
     ONE_ERROR_CODEC_TRYING_TO_ENCODE_UNSUPPORTED_OPCODE = 307,
+    ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE = 308,
+    ONE_ERROR_CODEC_PAYLOAD_WRITE_FAILED = 309,
     ONE_ERROR_CONNECTION_UNINITIALIZED = 400,
     ONE_ERROR_CONNECTION_HANDSHAKE_TIMEOUT = 401,
     ONE_ERROR_CONNECTION_HEALTH_TIMEOUT = 402,
@@ -57,6 +59,7 @@ typedef enum OneError {
     ONE_ERROR_CONNECTION_UNKNOWN_STATUS = 423,
     ONE_ERROR_CONNECTION_UPDATE_AFTER_ERROR = 424,
     ONE_ERROR_CONNECTION_UPDATE_READY_FAIL = 425,
+    ONE_ERROR_CONNECTION_BINARY_PAYLOAD_NOT_NEGOTIATED = 426,
     ONE_ERROR_MESSAGE_ALLOCATION_FAILED = 500,
     ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR = 501,
     ONE_ERROR_MESSAGE_IS_NULLPTR = 502,
@@ -101,6 +104,8 @@ typedef enum OneError {
     ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED = 809,
     ONE_ERROR_SERVER_SOCKET_IS_NULLPTR = 810,
     ONE_ERROR_SERVER_OBJECT_ALLOCATION_FAILED = 811,
+    ONE_ERROR_SERVER_PROPERTY_QUEUE_FULL = 812,
+    ONE_ERROR_SERVER_INVALID_LIVE_STATE_COALESCING = 813,
     ONE_ERROR_SOCKET_ACCEPT_NON_BLOCKING_FAILED = 900,
     ONE_ERROR_SOCKET_ACCEPT_UNINITIALIZED = 901,
     ONE_ERROR_SOCKET_ADDRESS_FAILED = 902,
@@ -120,6 +125,10 @@ typedef enum OneError {
     ONE_ERROR_SOCKET_SOCKET_OPTIONS_FAILED = 916,
     ONE_ERROR_SOCKET_SYSTEM_CLEANUP_FAIL = 917,
     ONE_ERROR_SOCKET_SYSTEM_INIT_FAIL = 918,
+    ONE_ERROR_SOCKET_POLLER_ADD_FAILED = 919,
+    ONE_ERROR_SOCKET_POLLER_CREATE_FAILED = 920,
+    ONE_ERROR_SOCKET_POLLER_UNAVAILABLE = 921,
+    ONE_ERROR_SOCKET_POLLER_WAIT_FAILED = 922,
     ONE_ERROR_VALIDATION_ARRAY_IS_NULLPTR = 1000,
     ONE_ERROR_VALIDATION_CALLBACK_IS_NULLPTR = 1001,
     ONE_ERROR_VALIDATION_CAPACITY_IS_NULLPTR = 1002,
@@ -142,7 +151,9 @@ typedef enum OneError {
     ONE_ERROR_VALIDATION_SIZE_IS_NULLPTR = 1019,
     ONE_ERROR_VALIDATION_VAL_IS_NULLPTR = 1020,
     ONE_ERROR_VALIDATION_VAL_SIZE_IS_TOO_SMALL = 1021,
-    ONE_ERROR_VALIDATION_VERSION_IS_NULLPTR = 1022
+    ONE_ERROR_VALIDATION_VERSION_IS_NULLPTR = 1022,
+    ONE_ERROR_VALIDATION_STATS_IS_NULLPTR = 1023,
+    ONE_ERROR_VALIDATION_SUBSYSTEM_IS_INVALID = 1024
 } OneError;
 
 ONE_EXPORT bool one_is_error(OneError err);
@@ -2,11 +2,14 @@
 
 #include <one/arcus/allocator.h>
 #include <one/arcus/internal/connection.h>
+#include <one/arcus/internal/dispatch.h>
 #include <one/arcus/internal/messages.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/internal/socket.h>
 #include <one/arcus/message.h>
 
+#include <utility>
+
 //#define ONE_ARCUS_CLIENT_LOGGING
 
 #ifdef ONE_ARCUS_CLIENT_LOGGING
@@ -18,6 +21,34 @@ namespace one {
 
 namespace {
 constexpr size_t connection_retry_delay_seconds = 5;
+
+// The messages a client sends, validated before queuing them.
+using OutgoingOpcodes =
+    OpcodeList<Opcode::soft_stop, Opcode::allocated, Opcode::metadata,
+               Opcode::host_information, Opcode::application_instance_information,
+               Opcode::custom_command>;
+
+// The client's callbacks can be any callable, e.g. capturing lambdas of the fake
+// agent, so the dispatch table calls them through these, with the callbacks as
+// userdata.
+
+void live_state(void *data, int players, int max_players, const String &name,
+                const String &map, const String &mode, const String &version) {
+    auto callbacks = reinterpret_cast<ClientCallbacks *>(data);
+    callbacks->_live_state(callbacks->_live_state_userdata, players, max_players, name,
+                           map, mode, version);
+}
+
+void reverse_metadata(void *data, Array *array) {
+    auto callbacks = reinterpret_cast<ClientCallbacks *>(data);
+    callbacks->_reverse_metadata(callbacks->_reverse_metadata_userdata, array);
+}
+
+void application_instance_status(void *data, int status) {
+    auto callbacks = reinterpret_cast<ClientCallbacks *>(data);
+    callbacks->_application_instance_status(
+        callbacks->_application_instance_status_userdata, status);
+}
 }
 
 // See: https://en.cppreference.com/w/cpp/language/value_initialization
@@ -68,11 +99,17 @@ OneError Client::init(const char *address, unsigned int port) {
 
     const auto max_incoming = Connection::max_message_default;
     const auto max_outgoing = Connection::max_message_default;
-    _connection = allocator::create<Connection>(max_incoming, max_outgoing);
+    {
+        allocator::ScopedSubsystem subsystem(allocator::Subsystem::connection);
+        _connection = allocator::create<Connection>(max_incoming, max_outgoing);
+    }
     if (_connection == nullptr) {
         shutdown();
         return ONE_ERROR_VALIDATION_CONNECTION_IS_NULLPTR;
     }
+    // The client only replies to the server's hello, so it can always accept
+    // binary payloads: they are only used if the server advertises them.
+    _connection->set_binary_payloads_supported(true);
 
     return ONE_ERROR_NONE;
 }
@@ -97,6 +134,7 @@ void Client::shutdown() {
     // See: https://en.cppreference.com/w/cpp/language/value_initialization
     // C++11 Value initialization
     _callbacks = ClientCallbacks{};
+    _dispatch.clear();
 }
 
 OneError Client::update() {
@@ -209,7 +247,7 @@ OneError Client::send_soft_stop(int timeout) {
 
     Message message;
     messages::prepare_soft_stop(timeout, message);
-    auto err = process_outgoing_message(message);
+    auto err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -222,7 +260,7 @@ OneError Client::send_allocated(Array &data) {
 
     Message message;
     messages::prepare_allocated(data, message);
-    auto err = process_outgoing_message(message);
+    auto err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -235,7 +273,7 @@ OneError Client::send_metadata(Array &data) {
 
     Message message;
     messages::prepare_metadata(data, message);
-    auto err = process_outgoing_message(message);
+    auto err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -248,7 +286,7 @@ OneError Client::send_host_information(Object &data) {
 
     Message message;
     messages::prepare_host_information(data, message);
-    auto err = process_outgoing_message(message);
+    auto err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -261,7 +299,7 @@ OneError Client::send_application_instance_information(Object &data) {
 
     Message message;
     messages::prepare_application_instance_information(data, message);
-    auto err = process_outgoing_message(message);
+    auto err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -274,7 +312,7 @@ OneError Client::send_custom_command(Array &data) {
 
     Message message;
     messages::prepare_custom_command(data, message);
-    auto err = process_outgoing_message(message);
+    auto err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -295,6 +333,7 @@ OneError Client::set_live_state_callback(
 
     _callbacks._live_state = callback;
     _callbacks._live_state_userdata = userdata;
+    _dispatch.set<Opcode::live_state>(live_state, &_callbacks);
     return ONE_ERROR_NONE;
 }
 
@@ -308,6 +347,7 @@ OneError Client::set_reverse_metadata_callback(
 
     _callbacks._reverse_metadata = callback;
     _callbacks._reverse_metadata_userdata = userdata;
+    _dispatch.set<Opcode::reverse_metadata>(reverse_metadata, &_callbacks);
     return ONE_ERROR_NONE;
 }
 
@@ -321,97 +361,23 @@ OneError Client::set_application_instance_status_callback(
 
     _callbacks._application_instance_status = callback;
     _callbacks._application_instance_status_userdata = userdata;
+    _dispatch.set<Opcode::application_instance_status>(application_instance_status,
+                                                       &_callbacks);
     return ONE_ERROR_NONE;
 }
 
 OneError Client::process_incoming_message(const Message &message) {
-    switch (message.code()) {
-        case Opcode::live_state:
-            if (_callbacks._live_state == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::live_state(message, _callbacks._live_state,
-                                          _callbacks._live_state_userdata);
-        case Opcode::reverse_metadata:
-            if (_callbacks._reverse_metadata == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::reverse_metadata(message, _callbacks._reverse_metadata,
-                                                _callbacks._reverse_metadata_userdata);
-        case Opcode::application_instance_status:
-            if (_callbacks._application_instance_status == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::application_instance_status(
-                message, _callbacks._application_instance_status,
-                _callbacks._application_instance_status_userdata);
-        default:
-            return ONE_ERROR_NONE;
-    }
+    return _dispatch.dispatch(message);
 }
 
-OneError Client::process_outgoing_message(const Message &message) {
-    OneError err = ONE_ERROR_NONE;
-    switch (message.code()) {
-        case Opcode::soft_stop: {
-            params::SoftStopRequest params;
-            err = validation::soft_stop(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::allocated: {
-            params::AllocatedRequest params;
-            err = validation::allocated(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::metadata: {
-            params::MetaDataRequest params;
-            err = validation::metadata(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::host_information: {
-            params::HostInformationResponse params;
-            err = validation::host_information(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::application_instance_information: {
-            params::ApplicationInstanceInformationResponse params;
-            err = validation::application_instance_information(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::custom_command: {
-            params::CustomCommandRequest params;
-            err = validation::custom_command(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        default:
-            return ONE_ERROR_NONE;
+OneError Client::process_outgoing_message(Message &&message) {
+    bool is_sent = false;
+    auto err = OutgoingOpcodes::validate(message, is_sent);
+    if (is_error(err)) {
+        return err;
+    }
+    if (!is_sent) {
+        return ONE_ERROR_NONE;
     }
 
     if (_connection == nullptr) {
@@ -423,7 +389,7 @@ OneError Client::process_outgoing_message(const Message &message) {
         return ONE_ERROR_SERVER_CONNECTION_NOT_READY;
     }
 
-    err = _connection->add_outgoing(message);
+    err = _connection->add_outgoing(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -5,6 +5,7 @@
 #include <mutex>
 
 #include <one/arcus/error.h>
+#include <one/arcus/internal/dispatch.h>
 #include <one/arcus/types.h>
 
 namespace i3d {
@@ -87,7 +88,7 @@ private:
     // send outgoing messages. If not, either ONE_ERROR_SERVER_CONNECTION_IS_NULLPTR or
     // ONE_ERROR_SERVER_CONNECTION_NOT_READY is returned and the message is
     // not sent.
-    OneError process_outgoing_message(const Message &message);
+    OneError process_outgoing_message(Message &&message);
 
     bool is_initialized() const {
         return _socket != nullptr;
@@ -104,6 +105,7 @@ private:
     Connection *_connection;
     bool _is_connected;
     ClientCallbacks _callbacks;
+    DispatchTable _dispatch;  // Forwards to _callbacks.
     std::chrono::steady_clock::time_point _last_connection_attempt_time;
 };
 
@@ -30,6 +30,8 @@ const char *error_text(OneError err) {
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CODEC_INVALID_MESSAGE_PAYLOAD_SIZE_TOO_BIG)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CODEC_INVALID_HEADER)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CODEC_TRYING_TO_ENCODE_UNSUPPORTED_OPCODE)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CODEC_PAYLOAD_WRITE_FAILED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_UNINITIALIZED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_HANDSHAKE_TIMEOUT)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_HEALTH_TIMEOUT)},
@@ -56,6 +58,7 @@ const char *error_text(OneError err) {
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_UNKNOWN_STATUS)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_UPDATE_AFTER_ERROR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_UPDATE_READY_FAIL)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_CONNECTION_BINARY_PAYLOAD_NOT_NEGOTIATED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_MESSAGE_ALLOCATION_FAILED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_MESSAGE_IS_NULLPTR)},
@@ -108,6 +111,8 @@ const char *error_text(OneError err) {
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SERVER_SOCKET_IS_NULLPTR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SERVER_OBJECT_ALLOCATION_FAILED)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SERVER_PROPERTY_QUEUE_FULL)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SERVER_INVALID_LIVE_STATE_COALESCING)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_ACCEPT_NON_BLOCKING_FAILED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_ACCEPT_UNINITIALIZED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_ADDRESS_FAILED)},
@@ -127,6 +132,10 @@ const char *error_text(OneError err) {
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_SOCKET_OPTIONS_FAILED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_SYSTEM_CLEANUP_FAIL)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_SYSTEM_INIT_FAIL)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_POLLER_ADD_FAILED)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_POLLER_CREATE_FAILED)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_POLLER_UNAVAILABLE)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_SOCKET_POLLER_WAIT_FAILED)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_ARRAY_IS_NULLPTR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_CALLBACK_IS_NULLPTR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_CAPACITY_IS_NULLPTR)},
@@ -149,7 +158,9 @@ const char *error_text(OneError err) {
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_SIZE_IS_NULLPTR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_VAL_IS_NULLPTR)},
         {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_VAL_SIZE_IS_TOO_SMALL)},
-        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_VERSION_IS_NULLPTR)}};
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_VERSION_IS_NULLPTR)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_STATS_IS_NULLPTR)},
+        {ONE_SYMBOL_STRING_PAIR(ONE_ERROR_VALIDATION_SUBSYSTEM_IS_INVALID)}};
     auto it = lookup.find(err);
     if (it == lookup.end()) {
         return "";
@@ -0,0 +1,144 @@
+#include <one/arcus/internal/arena.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <one/arcus/allocator.h>
+
+namespace i3d {
+namespace one {
+
+namespace {
+
+constexpr size_t minimum_chunk_capacity = 1024;
+
+// Same alignment as rapidjson's own allocators.
+size_t align(size_t size) {
+    return (size + 7u) & ~static_cast<size_t>(7u);
+}
+
+}  // namespace
+
+Arena::Arena() : _head(nullptr) {}
+
+Arena::~Arena() {
+    free_chunks();
+}
+
+size_t Arena::capacity() const {
+    size_t capacity = 0;
+    for (Chunk *chunk = _head; chunk != nullptr; chunk = chunk->next) {
+        capacity += chunk->capacity;
+    }
+    return capacity;
+}
+
+size_t Arena::size() const {
+    size_t size = 0;
+    for (Chunk *chunk = _head; chunk != nullptr; chunk = chunk->next) {
+        size += chunk->size;
+    }
+    return size;
+}
+
+void Arena::reset() {
+    if (_head == nullptr) {
+        return;
+    }
+
+    if (_head->next == nullptr) {
+        _head->size = 0;
+        return;
+    }
+
+    // Coalesce so that the same use fits into one chunk next time.
+    const size_t total = capacity();
+    free_chunks();
+    add_chunk(total);
+}
+
+void Arena::swap(Arena &other) {
+    std::swap(_head, other._head);
+}
+
+void *Arena::Malloc(size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    size = align(size);
+    if (_head == nullptr || _head->size + size > _head->capacity) {
+        const size_t grown =
+            (_head == nullptr) ? minimum_chunk_capacity : _head->capacity * 2;
+        if (!add_chunk(std::max(grown, size))) {
+            return nullptr;
+        }
+    }
+
+    void *p = chunk_data(_head) + _head->size;
+    _head->size += size;
+    return p;
+}
+
+void *Arena::Realloc(void *original, size_t original_size, size_t new_size) {
+    if (original == nullptr) {
+        return Malloc(new_size);
+    }
+
+    if (new_size == 0) {
+        return nullptr;
+    }
+
+    original_size = align(original_size);
+    new_size = align(new_size);
+    if (new_size <= original_size) {
+        return original;
+    }
+
+    // Grow in place if this is the last allocation and it still fits.
+    if (original == chunk_data(_head) + _head->size - original_size) {
+        const size_t increment = new_size - original_size;
+        if (_head->size + increment <= _head->capacity) {
+            _head->size += increment;
+            return original;
+        }
+    }
+
+    void *p = Malloc(new_size);
+    if (p == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(p, original, original_size);
+    return p;
+}
+
+char *Arena::chunk_data(Chunk *chunk) {
+    return reinterpret_cast<char *>(chunk) + align(sizeof(Chunk));
+}
+
+bool Arena::add_chunk(size_t capacity) {
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::payload);
+    void *p = allocator::alloc(align(sizeof(Chunk)) + capacity);
+    if (p == nullptr) {
+        return false;
+    }
+
+    Chunk *chunk = reinterpret_cast<Chunk *>(p);
+    chunk->next = _head;
+    chunk->capacity = capacity;
+    chunk->size = 0;
+    _head = chunk;
+    return true;
+}
+
+void Arena::free_chunks() {
+    while (_head != nullptr) {
+        Chunk *next = _head->next;
+        allocator::free(_head);
+        _head = next;
+    }
+}
+
+}  // namespace one
+}  // namespace i3d
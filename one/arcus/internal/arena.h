@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace i3d {
+namespace one {
+
+// Arena is a chunked bump allocator. Memory is handed out from the current
+// chunk and is only given back all at once, via reset, which keeps the chunks
+// for reuse. Once an arena has grown to fit its typical use it no longer
+// allocates.
+//
+// It implements the rapidjson Allocator concept and is the allocator used by
+// all arcus JSON documents, see rapidjson.h. Each Payload, Array and Object
+// owns an arena and resets it whenever its whole document is replaced, for
+// example when a message is parsed or copied into it. Like the rapidjson
+// MemoryPoolAllocator, memory of values that are overwritten without replacing
+// the whole document is only reclaimed on the next reset.
+class Arena final {
+public:
+    // rapidjson Allocator concept: Free does nothing.
+    static const bool kNeedFree = false;
+
+    Arena();
+    ~Arena();
+
+    // Total chunk memory held by the arena.
+    size_t capacity() const;
+
+    // Memory handed out since the last reset.
+    size_t size() const;
+
+    // Makes all memory available again. Any memory previously handed out must
+    // no longer be used. If the arena spilled over into more than one chunk,
+    // they are replaced by a single chunk large enough to hold all of them.
+    void reset();
+
+    // Exchanges the memory of the two arenas.
+    void swap(Arena &other);
+
+    // rapidjson Allocator concept.
+    void *Malloc(size_t size);
+    void *Realloc(void *original, size_t original_size, size_t new_size);
+    static void Free(void *) {}
+
+private:
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    struct Chunk {
+        Chunk *next;
+        size_t capacity;
+        size_t size;
+    };
+
+    static char *chunk_data(Chunk *chunk);
+    bool add_chunk(size_t capacity);
+    void free_chunks();
+
+    Chunk *_head;  // Chunk being allocated from. Older chunks follow it.
+};
+
+// Initial parse stack capacity of the documents using an arena. The arcus
+// payloads are small, so this is lower than the rapidjson default.
+constexpr size_t arena_document_stack_capacity = 256;
+
+}  // namespace one
+}  // namespace i3d
@@ -0,0 +1,379 @@
+#include <one/arcus/internal/binary.h>
+
+#include <stdint.h>
+#include <cstring>
+
+namespace i3d {
+namespace one {
+namespace binary {
+
+namespace {
+
+// MessagePack type bytes. Fixed size types store a small value or length in
+// the low bits of the type byte.
+enum Type : unsigned char {
+    positive_fixint = 0x00,  // 0xxxxxxx
+    fixmap = 0x80,           // 1000xxxx
+    fixarray = 0x90,         // 1001xxxx
+    fixstr = 0xa0,           // 101xxxxx
+    nil = 0xc0,
+    false_type = 0xc2,
+    true_type = 0xc3,
+    float32 = 0xca,
+    float64 = 0xcb,
+    uint8 = 0xcc,
+    uint16 = 0xcd,
+    uint32 = 0xce,
+    uint64 = 0xcf,
+    int8 = 0xd0,
+    int16 = 0xd1,
+    int32 = 0xd2,
+    int64 = 0xd3,
+    str8 = 0xd9,
+    str16 = 0xda,
+    str32 = 0xdb,
+    array16 = 0xdc,
+    array32 = 0xdd,
+    map16 = 0xde,
+    map32 = 0xdf,
+    negative_fixint = 0xe0  // 111xxxxx
+};
+
+//--------
+// Write.
+
+// Bytes that do not fit are dropped, but still counted in the length, so that
+// the required size is known when the data is too small.
+class Output final {
+public:
+    Output(char *data, size_t size) : _data(data), _size(size), _length(0) {}
+
+    void put(unsigned char byte) {
+        if (_length < _size) {
+            _data[_length] = static_cast<char>(byte);
+        }
+        ++_length;
+    }
+
+    void put(const void *data, size_t size) {
+        if (_length < _size) {
+            const size_t fitting = (size < _size - _length) ? size : _size - _length;
+            std::memcpy(_data + _length, data, fitting);
+        }
+        _length += size;
+    }
+
+    // Big-endian, the MessagePack byte order.
+    void put_uint(uint64_t value, size_t bytes) {
+        for (size_t i = bytes; i > 0; --i) {
+            put(static_cast<unsigned char>(value >> ((i - 1) * 8)));
+        }
+    }
+
+    size_t length() const {
+        return _length;
+    }
+
+private:
+    char *_data;
+    const size_t _size;
+    size_t _length;
+};
+
+void write_length(Output &out, size_t length, unsigned char fixed, size_t fixed_max,
+                  unsigned char type8, unsigned char type16, unsigned char type32) {
+    if (length <= fixed_max) {
+        out.put(static_cast<unsigned char>(fixed | length));
+    } else if (type8 != 0 && length <= UINT8_MAX) {
+        out.put(type8);
+        out.put_uint(length, 1);
+    } else if (length <= UINT16_MAX) {
+        out.put(type16);
+        out.put_uint(length, 2);
+    } else {
+        out.put(type32);
+        out.put_uint(length, 4);
+    }
+}
+
+void write_uint(Output &out, uint64_t value) {
+    if (value < 0x80) {
+        out.put(static_cast<unsigned char>(value));
+    } else if (value <= UINT8_MAX) {
+        out.put(uint8);
+        out.put_uint(value, 1);
+    } else if (value <= UINT16_MAX) {
+        out.put(uint16);
+        out.put_uint(value, 2);
+    } else if (value <= UINT32_MAX) {
+        out.put(uint32);
+        out.put_uint(value, 4);
+    } else {
+        out.put(uint64);
+        out.put_uint(value, 8);
+    }
+}
+
+void write_int(Output &out, int64_t value) {
+    if (value >= 0) {
+        write_uint(out, static_cast<uint64_t>(value));
+    } else if (value >= -32) {
+        out.put(static_cast<unsigned char>(value));
+    } else if (value >= INT8_MIN) {
+        out.put(int8);
+        out.put_uint(static_cast<uint8_t>(value), 1);
+    } else if (value >= INT16_MIN) {
+        out.put(int16);
+        out.put_uint(static_cast<uint16_t>(value), 2);
+    } else if (value >= INT32_MIN) {
+        out.put(int32);
+        out.put_uint(static_cast<uint32_t>(value), 4);
+    } else {
+        out.put(int64);
+        out.put_uint(static_cast<uint64_t>(value), 8);
+    }
+}
+
+void write_string(Output &out, const char *string, size_t length) {
+    write_length(out, length, fixstr, 31, str8, str16, str32);
+    out.put(string, length);
+}
+
+void write_value(Output &out, const rapidjson::Value &value) {
+    switch (value.GetType()) {
+        case rapidjson::kNullType:
+            out.put(nil);
+            return;
+        case rapidjson::kFalseType:
+            out.put(false_type);
+            return;
+        case rapidjson::kTrueType:
+            out.put(true_type);
+            return;
+        case rapidjson::kNumberType:
+            if (value.IsInt64()) {
+                write_int(out, value.GetInt64());
+            } else if (value.IsUint64()) {
+                write_uint(out, value.GetUint64());
+            } else {
+                const double d = value.GetDouble();
+                uint64_t bits = 0;
+                std::memcpy(&bits, &d, sizeof(bits));
+                out.put(float64);
+                out.put_uint(bits, 8);
+            }
+            return;
+        case rapidjson::kStringType:
+            write_string(out, value.GetString(), value.GetStringLength());
+            return;
+        case rapidjson::kArrayType:
+            write_length(out, value.Size(), fixarray, 15, 0, array16, array32);
+            for (const auto &element : value.GetArray()) {
+                write_value(out, element);
+            }
+            return;
+        case rapidjson::kObjectType:
+            write_length(out, value.MemberCount(), fixmap, 15, 0, map16, map32);
+            for (const auto &member : value.GetObject()) {
+                write_string(out, member.name.GetString(), member.name.GetStringLength());
+                write_value(out, member.value);
+            }
+            return;
+    }
+}
+
+//-------
+// Read.
+
+// Generates the rapidjson handler events of the encoded value, for
+// rapidjson::Document::Populate.
+class Reader final {
+public:
+    Reader(const char *data, size_t size)
+        : _data(reinterpret_cast<const unsigned char *>(data))
+        , _end(_data + size)
+        , _is_complete(false) {}
+
+    bool operator()(rapidjson::Document &handler) {
+        _is_complete = read_value(handler, 0) && _data == _end;
+        return _is_complete;
+    }
+
+    // Whether the last generation read exactly one value and all data.
+    bool is_complete() const {
+        return _is_complete;
+    }
+
+private:
+    bool read_uint(size_t bytes, uint64_t &value) {
+        if (static_cast<size_t>(_end - _data) < bytes) return false;
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value = (value << 8) | _data[i];
+        }
+        _data += bytes;
+        return true;
+    }
+
+    bool read_string(size_t length, const char *&string) {
+        if (static_cast<size_t>(_end - _data) < length) return false;
+        string = reinterpret_cast<const char *>(_data);
+        _data += length;
+        return true;
+    }
+
+    // Reads the length of a string, array or map given its type byte.
+    bool read_length(unsigned char type, size_t &length) {
+        uint64_t value = 0;
+        switch (type) {
+            case str8:
+                if (!read_uint(1, value)) return false;
+                break;
+            case str16:
+            case array16:
+            case map16:
+                if (!read_uint(2, value)) return false;
+                break;
+            case str32:
+            case array32:
+            case map32:
+                if (!read_uint(4, value)) return false;
+                break;
+            default:
+                if ((type & 0xe0) == fixstr) {
+                    value = type & 0x1f;
+                } else {
+                    value = type & 0x0f;
+                }
+                break;
+        }
+        length = static_cast<size_t>(value);
+        return true;
+    }
+
+    bool read_key(rapidjson::Document &handler) {
+        if (_data == _end) return false;
+        const unsigned char type = *_data++;
+        if ((type & 0xe0) != fixstr && type != str8 && type != str16 && type != str32) {
+            return false;  // JSON keys are strings.
+        }
+        size_t length = 0;
+        const char *string = nullptr;
+        if (!read_length(type, length) || !read_string(length, string)) return false;
+        return handler.Key(string, static_cast<rapidjson::SizeType>(length), true);
+    }
+
+    // The depth is the number of arrays and maps the value is in.
+    bool read_value(rapidjson::Document &handler, size_t depth) {
+        if (_data == _end) return false;
+        const unsigned char type = *_data++;
+
+        if (type < fixmap) {
+            return handler.Uint(type);
+        }
+        if (type >= negative_fixint) {
+            return handler.Int(static_cast<int8_t>(type));
+        }
+
+        uint64_t value = 0;
+        size_t length = 0;
+        switch (type) {
+            case nil:
+                return handler.Null();
+            case false_type:
+                return handler.Bool(false);
+            case true_type:
+                return handler.Bool(true);
+            case uint8:
+            case uint16:
+            case uint32:
+            case uint64:
+                if (!read_uint(size_t(1) << (type - uint8), value)) return false;
+                return handler.Uint64(value);
+            case int8:
+                if (!read_uint(1, value)) return false;
+                return handler.Int(static_cast<int8_t>(value));
+            case int16:
+                if (!read_uint(2, value)) return false;
+                return handler.Int(static_cast<int16_t>(value));
+            case int32:
+                if (!read_uint(4, value)) return false;
+                return handler.Int(static_cast<int32_t>(value));
+            case int64:
+                if (!read_uint(8, value)) return false;
+                return handler.Int64(static_cast<int64_t>(value));
+            case float32: {
+                if (!read_uint(4, value)) return false;
+                const uint32_t bits = static_cast<uint32_t>(value);
+                float f = 0.f;
+                std::memcpy(&f, &bits, sizeof(f));
+                return handler.Double(f);
+            }
+            case float64: {
+                if (!read_uint(8, value)) return false;
+                double d = 0.0;
+                std::memcpy(&d, &value, sizeof(d));
+                return handler.Double(d);
+            }
+            default:
+                break;
+        }
+
+        if ((type & 0xe0) == fixstr || type == str8 || type == str16 || type == str32) {
+            const char *string = nullptr;
+            if (!read_length(type, length) || !read_string(length, string)) return false;
+            return handler.String(string, static_cast<rapidjson::SizeType>(length), true);
+        }
+
+        const bool is_array = (type & 0xf0) == fixarray || type == array16 || type == array32;
+        const bool is_map = (type & 0xf0) == fixmap || type == map16 || type == map32;
+        if ((is_array || is_map) && max_depth <= depth) return false;
+
+        if (is_array) {
+            if (!read_length(type, length)) return false;
+            // Each element takes at least a byte, reject lengths that can't
+            // fit before reading any.
+            if (static_cast<size_t>(_end - _data) < length) return false;
+            if (!handler.StartArray()) return false;
+            for (size_t i = 0; i < length; ++i) {
+                if (!read_value(handler, depth + 1)) return false;
+            }
+            return handler.EndArray(static_cast<rapidjson::SizeType>(length));
+        }
+
+        if (is_map) {
+            if (!read_length(type, length)) return false;
+            if (static_cast<size_t>(_end - _data) / 2 < length) return false;
+            if (!handler.StartObject()) return false;
+            for (size_t i = 0; i < length; ++i) {
+                if (!read_key(handler) || !read_value(handler, depth + 1)) return false;
+            }
+            return handler.EndObject(static_cast<rapidjson::SizeType>(length));
+        }
+
+        // Binary, extension and reserved types have no JSON equivalent.
+        return false;
+    }
+
+    const unsigned char *_data;
+    const unsigned char *const _end;
+    bool _is_complete;
+};
+
+}  // namespace
+
+void write(const rapidjson::Value &value, char *data, size_t data_size, size_t &length) {
+    Output out(data, data_size);
+    write_value(out, value);
+    length = out.length();
+}
+
+bool read(const char *data, size_t size, rapidjson::Document &document) {
+    Reader reader(data, size);
+    document.Populate(reader);
+    return reader.is_complete();
+}
+
+}  // namespace binary
+}  // namespace one
+}  // namespace i3d
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <one/arcus/internal/rapidjson/document.h>
+
+namespace rapidjson = RAPIDJSON_NAMESPACE;
+
+namespace i3d {
+namespace one {
+
+// Compact binary encoding of JSON values, used for message payloads when both
+// sides of a connection support it, see codec::Hello. The encoding is the
+// subset of MessagePack that maps to JSON: nil, booleans, integers, floats,
+// strings, arrays and maps with string keys.
+namespace binary {
+
+// Encodes the value into data, which is data_size bytes. Sets length to the
+// full encoded length, which is larger than data_size if it did not fit, in
+// which case the data is incomplete.
+void write(const rapidjson::Value &value, char *data, size_t data_size, size_t &length);
+
+// Decodes the size bytes of data into the document. Returns false, leaving
+// the document unchanged, if the data is not a single complete value or has
+// more than max_depth nested arrays and maps.
+bool read(const char *data, size_t size, rapidjson::Document &document);
+
+constexpr size_t max_depth = 64;
+
+}  // namespace binary
+}  // namespace one
+}  // namespace i3d
@@ -0,0 +1,107 @@
+#include <one/arcus/internal/circular_buffer.h>
+
+#include <assert.h>
+#include <algorithm>
+#include <cstring>
+
+#include <one/arcus/allocator.h>
+
+namespace i3d {
+namespace one {
+
+CircularBuffer::CircularBuffer(size_t capacity)
+    : _capacity(capacity), _size(0), _read(0) {
+    assert(_capacity > 0);
+    void *p = allocator::alloc(sizeof(char) * capacity);
+    assert(p);
+    _buffer = reinterpret_cast<char *>(p);
+}
+
+CircularBuffer::~CircularBuffer() {
+    if (_buffer != nullptr) {
+        allocator::free(_buffer);
+        _buffer = nullptr;
+    }
+}
+
+void CircularBuffer::put(const void *data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    assert(data);
+    assert(length <= free_size());
+
+    // At most two copies are needed: one up to the end of the buffer memory and
+    // one for the remainder wrapping around to the start.
+    const char *source = reinterpret_cast<const char *>(data);
+    while (length > 0) {
+        void *span = nullptr;
+        size_t span_length = 0;
+        peek_write(&span, span_length);
+        const size_t copy_length = std::min(length, span_length);
+        memcpy(span, source, copy_length);
+        commit_write(copy_length);
+        source += copy_length;
+        length -= copy_length;
+    }
+}
+
+void CircularBuffer::peek_read(void **data, size_t &length) {
+    assert(data);
+    *data = _buffer + _read;
+    length = std::min(_size, _capacity - _read);
+}
+
+void CircularBuffer::peek_read(void **first, size_t &first_length, void **second,
+                               size_t &second_length) {
+    assert(second);
+    peek_read(first, first_length);
+    *second = _buffer;
+    second_length = _size - first_length;
+}
+
+void CircularBuffer::commit_read(size_t length) {
+    assert(length <= _size);
+    _size -= length;
+    if (_size == 0) {
+        // Rewind when empty so that the next spans are as large as possible.
+        _read = 0;
+        return;
+    }
+    _read = (_read + length) % _capacity;
+}
+
+void CircularBuffer::peek_write(void **data, size_t &length) {
+    assert(data);
+    const size_t end = _read + _size;
+    if (end < _capacity) {
+        // Free space after the data, up to the end of the buffer memory.
+        *data = _buffer + end;
+        length = _capacity - end;
+    } else {
+        // Data wraps, the free space is between the end and the front.
+        *data = _buffer + (end - _capacity);
+        length = _capacity - _size;
+    }
+}
+
+void CircularBuffer::commit_write(size_t length) {
+    assert(length <= free_size());
+    _size += length;
+}
+
+void CircularBuffer::linearize() {
+    if (_read == 0) {
+        return;
+    }
+
+    if (_read + _size <= _capacity) {
+        memmove(_buffer, _buffer + _read, _size);
+    } else {
+        std::rotate(_buffer, _buffer + _read, _buffer + _capacity);
+    }
+    _read = 0;
+}
+
+}  // namespace one
+}  // namespace i3d
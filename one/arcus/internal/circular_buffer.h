@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace i3d {
+namespace one {
+
+// CircularBuffer is a fixed-size FIFO byte buffer. Data is added at the write
+// head and removed from the read head without moving the bytes in between.
+//
+// Readers and writers access the buffer memory directly through contiguous
+// spans: peek a span, use some or all of it, then commit the number of bytes
+// used. Since the stored data may wrap around the end of the buffer, a span
+// can be shorter than size (for reading) or free_size (for writing).
+// linearize can be used in that case to make all data and free space
+// contiguous.
+class CircularBuffer final {
+public:
+    CircularBuffer(size_t capacity);
+    ~CircularBuffer();
+
+    size_t capacity() const {
+        return _capacity;
+    }
+    size_t size() const {
+        return _size;
+    }
+    size_t free_size() const {
+        return _capacity - _size;
+    }
+
+    void clear() {
+        _read = 0;
+        _size = 0;
+    }
+
+    // Copies the given data and adds it to the end of the buffer. length must
+    // be less than or equal to free_size.
+    void put(const void *data, size_t length);
+
+    // Provides the contiguous readable span starting at the front of the
+    // buffer. length is set to the span size, which is at most size.
+    void peek_read(void **data, size_t &length);
+
+    // Provides all readable data as two spans. The first span starts at the
+    // front of the buffer, the second holds the data that wraps around to the
+    // start of the buffer memory and is empty if none does. The lengths add up
+    // to size.
+    void peek_read(void **first, size_t &first_length, void **second,
+                   size_t &second_length);
+
+    // Drops the number of given bytes from the front of the buffer, freeing
+    // capacity. length must be less than or equal to size.
+    void commit_read(size_t length);
+
+    // Provides the contiguous writable span starting at the end of the buffer.
+    // length is set to the span size, which is at most free_size.
+    void peek_write(void **data, size_t &length);
+
+    // Adds the number of given bytes, previously written to the span returned
+    // by peek_write, to the end of the buffer. length must be less than or
+    // equal to the peeked span length.
+    void commit_write(size_t length);
+
+    // Moves the stored data to the start of the buffer memory, so that the
+    // readable span covers size bytes and the writable span covers free_size
+    // bytes. This copies the stored data and should only be used when a span
+    // is too small.
+    void linearize();
+
+private:
+    CircularBuffer() = delete;
+    CircularBuffer(CircularBuffer &other) = delete;
+
+    char *_buffer;
+    size_t _capacity;
+    size_t _size;
+    size_t _read;  // Offset of the front of the buffer.
+};
+
+}  // namespace one
+}  // namespace i3d
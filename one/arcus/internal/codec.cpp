@@ -1,9 +1,13 @@
 #include <one/arcus/internal/codec.h>
 
+#include <one/arcus/allocator.h>
+#include <one/arcus/internal/binary.h>
 #include <one/arcus/internal/endian.h>
 #include <one/arcus/internal/messages.h>
+#include <one/arcus/internal/rapidjson/writer.h>
 #include <one/arcus/message.h>
 
+#include <assert.h>
 #include <cstring>
 #include <algorithm>
 
@@ -11,29 +15,127 @@ namespace i3d {
 namespace one {
 namespace codec {
 
+namespace {
+
+// A rapidjson output stream that writes to a fixed size buffer. Characters
+// that do not fit are dropped, but still counted in the length, so that the
+// required size is known when the buffer is too small.
+class FixedBufferStream final {
+public:
+    typedef char Ch;
+
+    FixedBufferStream(char *data, size_t size) : _data(data), _size(size), _length(0) {}
+
+    void Put(Ch c) {
+        if (_length < _size) {
+            _data[_length] = c;
+        }
+        ++_length;
+    }
+    void Flush() {}
+
+    size_t length() const {
+        return _length;
+    }
+
+private:
+    char *_data;
+    const size_t _size;
+    size_t _length;
+};
+
+// Serializes the payload as JSON directly into the given data. Sets
+// payload_length to the full length of the JSON, which is larger than
+// data_size if it did not fit. An empty payload has a length of zero. Fails
+// with ONE_ERROR_CODEC_PAYLOAD_WRITE_FAILED if a value can't be written as
+// JSON, e.g. a NaN number.
+OneError write_payload(const Payload &payload, char *data, size_t data_size,
+                       size_t &payload_length) {
+    if (payload.is_empty()) {
+        payload_length = 0;
+        return ONE_ERROR_NONE;
+    }
+
+    // The writer's nesting stack is allocated from a local buffer, so that
+    // writing does not allocate unless the payload is very deeply nested.
+    size_t stack_buffer[128];
+    rapidjson::MemoryPoolAllocator<> stack_allocator(stack_buffer, sizeof(stack_buffer));
+
+    FixedBufferStream stream(data, data_size);
+    rapidjson::Writer<FixedBufferStream, rapidjson::UTF8<>, rapidjson::UTF8<>,
+                      rapidjson::MemoryPoolAllocator<>>
+        writer(stream, &stack_allocator);
+    if (!payload.get().Accept(writer)) {
+        return ONE_ERROR_CODEC_PAYLOAD_WRITE_FAILED;
+    }
+    payload_length = stream.length();
+    return ONE_ERROR_NONE;
+}
+
+// Same as above, in the given encoding.
+OneError write_payload(const Payload &payload, PayloadEncoding encoding, char *data,
+                       size_t data_size, size_t &payload_length) {
+    if (encoding == PayloadEncoding::json || payload.is_empty()) {
+        return write_payload(payload, data, data_size, payload_length);
+    }
+
+    binary::write(payload.get(), data, data_size, payload_length);
+    return ONE_ERROR_NONE;
+}
+
+// Writes the header in wire format to the given data, which must be at least
+// header_size() bytes.
+OneError write_header(const Header &header, void *data) {
+    if (!validate_header(header)) {
+        return ONE_ERROR_CODEC_INVALID_HEADER;
+    }
+
+    // Endian handling. Network byte order for the Header itself is
+    // non-standard: little.
+    Header swapped_header(header);
+    if (endian::which() == endian::Arch::little) {
+        swapped_header.length = endian::swap_uint32(header.length);
+        swapped_header.packet_id = endian::swap_uint32(header.packet_id);
+    }
+
+    std::memcpy(data, &swapped_header, header_size());
+    return ONE_ERROR_NONE;
+}
+
+}  // namespace
+
 const Hello hello = Hello{{'a', 'r', 'c', 0}, (char)0x1, 0};  // namespace codec
+const Hello hello_binary = Hello{{'a', 'r', 'c', 0}, (char)0x2, 0};
 
 bool validate_hello(const Hello &other) {
-    const auto cmp = std::memcmp(&hello, &other, hello_size());
-    return cmp == 0;
+    return std::memcmp(&hello, &other, hello_size()) == 0 ||
+           std::memcmp(&hello_binary, &other, hello_size()) == 0;
 }
 
 const Hello &valid_hello() {
     return hello;
 }
 
+const Hello &binary_hello() {
+    return hello_binary;
+}
+
+bool is_binary_hello(const Hello &other) {
+    return other.version == hello_binary.version;
+}
+
 bool validate_header(const Header &header) {
     // Minimal validation in the codec at the moment. Opcode will be handled
     // by message layer. Length will be handled by document reader.
-    // Flags are not used at the moment and should be zero.
+    // Only known flags may be set.
     bool is_valid = true;
-    is_valid &= header.flags == (char)0x0;
+    is_valid &= (header.flags & ~header_flag_binary) == (char)0x0;
     is_valid &= is_opcode_supported(static_cast<Opcode>(header.opcode));
     return is_valid;
 }
 
-OneError data_to_message(const void *data, const size_t data_size, size_t &read_data_size,
-                      Header &header, Message &message) {
+OneError data_to_message_header(const void *data, const size_t data_size,
+                                size_t &message_size, Header &header) {
     if (data_size < header_size()) {
         return ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_HEADER;
     }
@@ -55,19 +157,29 @@ OneError data_to_message(const void *data, const size_t data_size, size_t &read_
         return ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_PAYLOAD;
     }
 
-    read_data_size = total_message_size;
+    message_size = total_message_size;
+    return ONE_ERROR_NONE;
+}
 
-    Payload payload;
+OneError data_to_message(const void *data, const size_t data_size, size_t &read_data_size,
+                      Header &header, Message &message) {
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::codec);
+    auto err = data_to_message_header(data, data_size, read_data_size, header);
+    if (is_error(err)) return err;
 
+    // Parse straight into the message, so that its payload memory is reused.
+    const Opcode code = static_cast<Opcode>(header.opcode);
     if (0 < header.length) {
         const size_t payload_length = header.length;
         const char *payload_data = static_cast<const char *>(data) + codec::header_size();
-        err = payload.from_json({payload_data, payload_length});
-        if (is_error(err)) return err;
+        if (header.flags & header_flag_binary) {
+            err = message.init_binary(code, {payload_data, payload_length});
+        } else {
+            err = message.init(code, {payload_data, payload_length});
+        }
+    } else {
+        err = message.init(code, Payload());
     }
-
-    const Opcode code = static_cast<Opcode>(header.opcode);
-    err = message.init(code, payload);
     if (is_error(err)) {
         message.reset();
         return err;
@@ -78,31 +190,56 @@ OneError data_to_message(const void *data, const size_t data_size, size_t &read_
 
 OneError message_to_data(const uint32_t packet_id, const Message &message,
                       size_t &data_length,
-                      std::array<char, header_size() + payload_max_size()> &data) {
-    std::array<char, payload_max_size()> payload_data;
-    size_t payload_length = 0;
-    auto err = payload_to_data(message.payload(), payload_length, payload_data);
-    if (is_error(err)) return err;
+                      std::array<char, header_size() + payload_max_size()> &data,
+                      PayloadEncoding encoding) {
+    return message_to_data(packet_id, message, data.data(), data.size(), data_length,
+                           encoding);
+}
+
+OneError message_to_data(const uint32_t packet_id, const Message &message, void *data,
+                      const size_t data_size, size_t &data_length,
+                      PayloadEncoding encoding) {
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::codec);
+    assert(data != nullptr);
+    if (data_size < header_size()) {
+        return ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE;
+    }
 
     // See: https://en.cppreference.com/w/cpp/language/value_initialization
     // C++11 Value initialization
     Header header{};
     header.opcode = static_cast<char>(message.code());
     header.packet_id = packet_id;
-    assert(payload_length <= UINT32_MAX);
-    header.length = static_cast<uint32_t>(payload_length);
+    if (encoding == PayloadEncoding::binary) {
+        header.flags = header_flag_binary;
+    }
+    if (!validate_header(header)) {
+        return ONE_ERROR_CODEC_INVALID_HEADER;
+    }
 
-    std::array<char, header_size()> header_data;
-    err = header_to_data(header, header_data);
+    // Serialize the payload in a single pass directly after the space reserved
+    // for the header, then write the header once the payload length is known.
+    char *out = static_cast<char *>(data);
+    const size_t payload_capacity =
+        std::min(data_size - header_size(), payload_max_size());
+    size_t payload_length = 0;
+    auto err = write_payload(message.payload(), encoding, out + header_size(),
+                             payload_capacity, payload_length);
     if (is_error(err)) return err;
 
-    data_length = header_size() + payload_length;
-    std::copy(header_data.cbegin(), header_data.cend(), data.begin());
-
-    if (0 < payload_length) {
-        std::copy_n(payload_data.cbegin(), payload_length, data.begin() + header_size());
+    if (payload_max_size() < payload_length) {
+        return ONE_ERROR_CODEC_INVALID_MESSAGE_PAYLOAD_SIZE_TOO_BIG;
     }
+    if (payload_capacity < payload_length) {
+        return ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE;
+    }
+
+    assert(payload_length <= UINT32_MAX);
+    header.length = static_cast<uint32_t>(payload_length);
+    err = write_header(header, out);
+    if (is_error(err)) return err;
 
+    data_length = header_size() + payload_length;
     return ONE_ERROR_NONE;
 }
 
@@ -134,20 +271,7 @@ OneError data_to_header(const void *data, size_t length, Header &header) {
 }
 
 OneError header_to_data(const Header &header, std::array<char, header_size()> &data) {
-    if (!validate_header(header)) {
-        return ONE_ERROR_CODEC_INVALID_HEADER;
-    }
-
-    // Endian handling. Network byte order for the Header itself is
-    // non-standard: little.
-    Header swapped_header(header);
-    if (endian::which() == endian::Arch::little) {
-        swapped_header.length = endian::swap_uint32(header.length);
-        swapped_header.packet_id = endian::swap_uint32(header.packet_id);
-    }
-
-    std::memcpy(data.data(), &swapped_header, header_size());
-    return ONE_ERROR_NONE;
+    return write_header(header, data.data());
 }
 
 OneError data_to_payload(const void *data, size_t length, Payload &payload) {
@@ -168,19 +292,13 @@ OneError data_to_payload(const void *data, size_t length, Payload &payload) {
 
 OneError payload_to_data(const Payload &payload, size_t &payload_length,
                       std::array<char, payload_max_size()> &data) {
-    if (payload.is_empty()) {
-        payload_length = 0;
-        return ONE_ERROR_NONE;
-    }
-
-    auto str = payload.to_json();
-    payload_length = str.size();
+    auto err = write_payload(payload, data.data(), data.size(), payload_length);
+    if (is_error(err)) return err;
 
     if (payload_max_size() < payload_length) {
         return ONE_ERROR_CODEC_INVALID_MESSAGE_PAYLOAD_SIZE_TOO_BIG;
     }
 
-    std::memcpy(data.data(), str.c_str(), payload_length);
     return ONE_ERROR_NONE;
 }
 
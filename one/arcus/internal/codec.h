@@ -36,6 +36,14 @@ bool validate_hello(const Hello &hello);
 // Returns the valid, expected Hello values.
 const Hello &valid_hello();
 
+// Returns the Hello sent by a side that supports binary payloads. Its version
+// is one higher than valid_hello's. Older SDKs fail the handshake on it, so it
+// must only be sent to peers known to support it.
+const Hello &binary_hello();
+
+// Returns true if the given valid Hello advertises binary payload support.
+bool is_binary_hello(const Hello &hello);
+
 //---------------
 // Arcus Message.
 
@@ -49,6 +57,13 @@ struct Header {
 };
 static_assert(sizeof(Header) == 12, "header struct alignment");
 
+// Header flags.
+// The payload is in the binary encoding instead of JSON, see binary::write.
+constexpr char header_flag_binary = 0x1;
+
+// The encoding of message payloads on the wire.
+enum class PayloadEncoding { json, binary };
+
 constexpr size_t header_size() {
     return sizeof(Header);
 }
@@ -66,17 +81,35 @@ static_assert(sizeof(header_size() + payload_max_size()) <= 1024 * 128,
 // this version of the SDK.
 bool validate_header(const Header &header);
 
+// Read the header of the first message from data of at most data_size bytes, without
+// reading its payload. The message_size is set to codec::header_size() +
+// header.length. Returns the same errors as data_to_message if data does not
+// contain the entire message.
+OneError data_to_message_header(const void *data, const size_t data_size,
+                                size_t &message_size, Header &header);
+
 // Convert the first message from data from at most data_size bytes. The read_data_size
 // will contain the number of byte read and be equal to: codec::header_size() +
 // header.length. The read_data_size is at least codec::header_size() and at most
-// codec::header_size() + codec::payload_max_size().
+// codec::header_size() + codec::payload_max_size(). The payload is decoded
+// according to the header flags.
 OneError data_to_message(const void *data, const size_t data_size, size_t &read_data_size,
                       Header &header, Message &message);
 
 // Convert a Message to byte data.
 OneError message_to_data(const uint32_t packet_id, const Message &message,
                       size_t &data_length,
-                      std::array<char, header_size() + payload_max_size()> &data);
+                      std::array<char, header_size() + payload_max_size()> &data,
+                      PayloadEncoding encoding = PayloadEncoding::json);
+
+// Convert a Message to byte data, written to the given data of data_size bytes.
+// The data_length is set to the number of bytes written. Returns
+// ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE, without writing a complete
+// message, if the data_size is too small for the message, and
+// ONE_ERROR_CODEC_PAYLOAD_WRITE_FAILED if the payload can't be encoded.
+OneError message_to_data(const uint32_t packet_id, const Message &message, void *data,
+                      const size_t data_size, size_t &data_length,
+                      PayloadEncoding encoding = PayloadEncoding::json);
 
 // Convert byte data to a Header. Length must be header_size().
 OneError data_to_header(const void *data, size_t length, Header &header);
@@ -2,7 +2,9 @@
 
 #include <assert.h>
 #include <cstring>
+#include <utility>
 
+#include <one/arcus/allocator.h>
 #include <one/arcus/message.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/c_platform.h>
@@ -46,13 +48,18 @@ void log(const Socket &socket, std::function<void(OStringStream &)> cb) {
 Connection::Connection(size_t max_messages_in, size_t max_messages_out)
     : _socket(nullptr)
     , _status(Status::uninitialized)
+    , _is_binary_supported(false)
+    , _is_binary_negotiated(false)
     , _in_stream(connection::stream_receive_buffer_size())
     , _out_stream(connection::stream_send_buffer_size())
+    , _packet_id(1)
     , _incoming_messages(max_messages_in)
     , _outgoing_messages(max_messages_out)
     , _handshake_timer(handshake_timeout_seconds)
     , _health_checker(HealthChecker::health_check_send_interval_seconds,
-                      HealthChecker::health_check_receive_interval_seconds) {
+                      HealthChecker::health_check_receive_interval_seconds)
+    , _own_stats()
+    , _stats(&_own_stats) {
     _handshake_timer.sync_now();
 }
 
@@ -62,28 +69,62 @@ void Connection::init(Socket &socket) {
     _handshake_timer.sync_now();
     _health_checker.reset_receive_timer();
     _status = Status::handshake_not_started;
+    _is_binary_negotiated = false;
 }
 
 void Connection::shutdown() {
     _out_stream.clear();
     _in_stream.clear();
+    _packet_id = 1;
     _outgoing_messages.clear();
     _incoming_messages.clear();
     _status = Status::uninitialized;
+    _is_binary_negotiated = false;
     _socket = nullptr;
 }
 
+void Connection::set_binary_payloads_supported(bool is_supported) {
+    assert(_status == Status::uninitialized);
+    _is_binary_supported = is_supported;
+}
+
+bool Connection::is_binary_negotiated() const {
+    return _is_binary_negotiated;
+}
+
+const Connection::Stats &Connection::stats() const {
+    return *_stats;
+}
+
+void Connection::set_stats(Stats &stats) {
+    _stats = &stats;
+}
+
 Connection::Status Connection::status() const {
     return _status;
 }
 
 OneError Connection::add_outgoing(const Message &message) {
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::connection);
     if (_status == Status::uninitialized) return ONE_ERROR_CONNECTION_UNINITIALIZED;
 
     if (_outgoing_messages.size() == _outgoing_messages.capacity())
         return ONE_ERROR_CONNECTION_OUTGOING_QUEUE_INSUFFICIENT_SPACE;
 
     _outgoing_messages.push(message);
+    _stats->outgoing_queue_peak.raise_to(_outgoing_messages.size());
+    return ONE_ERROR_NONE;
+}
+
+OneError Connection::add_outgoing(Message &&message) {
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::connection);
+    if (_status == Status::uninitialized) return ONE_ERROR_CONNECTION_UNINITIALIZED;
+
+    if (_outgoing_messages.size() == _outgoing_messages.capacity())
+        return ONE_ERROR_CONNECTION_OUTGOING_QUEUE_INSUFFICIENT_SPACE;
+
+    _outgoing_messages.push(std::move(message));
+    _stats->outgoing_queue_peak.raise_to(_outgoing_messages.size());
     return ONE_ERROR_NONE;
 }
 
@@ -103,13 +144,27 @@ OneError Connection::remove_incoming(
         return ONE_ERROR_CONNECTION_QUEUE_EMPTY;
     }
 
-    Message &message = _incoming_messages.pop();
+    // Move the message out of the queue, so that the queue slot can be
+    // reused while the callback runs, e.g. if it releases a lock.
+    Message &message = _removed_message;
+    _incoming_messages.pop(message);
     auto err = read_callback(message);
     message.reset();
 
     return err;
 }
 
+OneError Connection::pop_incoming(Message &message) {
+    if (_status == Status::uninitialized) return ONE_ERROR_CONNECTION_UNINITIALIZED;
+
+    if (_incoming_messages.size() == 0) {
+        return ONE_ERROR_CONNECTION_QUEUE_EMPTY;
+    }
+
+    _incoming_messages.pop(message);
+    return ONE_ERROR_NONE;
+}
+
 OneError Connection::initiate_handshake() {
     if (_status == Status::uninitialized) return ONE_ERROR_CONNECTION_UNINITIALIZED;
     assert(_status == Status::handshake_not_started);
@@ -133,6 +188,8 @@ OneError Connection::process_health() {
 }
 
 OneError Connection::update() {
+    allocator::ScopedSubsystem subsystem(allocator::Subsystem::connection);
+    ScopedStatTimer timer(_stats->update_time);
     if (_status == Status::uninitialized) return ONE_ERROR_CONNECTION_UNINITIALIZED;
     if (_status == Status::error) return ONE_ERROR_CONNECTION_UPDATE_AFTER_ERROR;
 
@@ -193,14 +250,16 @@ OneError Connection::try_send_hello() {
     // send will succeed since it is tiny and partial sends
     // are rare edge cases in general.
     if (stream.size() == 0) {
-        stream.put(&codec::valid_hello(), codec::hello_size());
+        const auto &hello =
+            _is_binary_supported ? codec::binary_hello() : codec::valid_hello();
+        stream.put(&hello, codec::hello_size());
     }
 
     // Get remaining buffer.
-    const auto size = stream.size();
-    assert(size > 0);
     void *data = nullptr;
-    stream.peek(size, &data);
+    size_t size = 0;
+    stream.peek_read(&data, size);
+    assert(size > 0);
     assert(data != nullptr);
 
     // Send as much as possible.
@@ -212,7 +271,7 @@ OneError Connection::try_send_hello() {
     if (sent == 0) return ONE_ERROR_CONNECTION_TRY_AGAIN;
 
     // Remove from send stream, check if finished.
-    stream.trim(sent);
+    stream.commit_read(sent);
     if (stream.size() > 0) return ONE_ERROR_CONNECTION_TRY_AGAIN;
 
     return ONE_ERROR_NONE;
@@ -247,11 +306,21 @@ OneError Connection::try_receive_hello() {
     }
 
     // Read and validate the full hello from the receive buffer.
-    codec::Hello *data;
-    _in_stream.get(codec::hello_size(), reinterpret_cast<void **>(&data));
+    void *data = nullptr;
+    size_t length = 0;
+    _in_stream.peek_read(&data, length);
+    if (length < codec::hello_size()) {
+        _in_stream.linearize();
+        _in_stream.peek_read(&data, length);
+    }
     assert(data != nullptr);
+    assert(length >= codec::hello_size());
 
-    if (!codec::validate_hello(*data)) {
+    const auto &received_hello = *reinterpret_cast<codec::Hello *>(data);
+    const bool is_valid = codec::validate_hello(received_hello);
+    _is_binary_negotiated = _is_binary_supported && codec::is_binary_hello(received_hello);
+    _in_stream.commit_read(codec::hello_size());
+    if (!is_valid) {
         return ONE_ERROR_CONNECTION_HELLO_INVALID;
     }
     return ONE_ERROR_NONE;
@@ -259,13 +328,13 @@ OneError Connection::try_receive_hello() {
 
 // There are two hello packets. The initial codec::hello sent from the
 // handshake initiater, and the response codec::Header message with a
-// hello opcode sent in response. This is the response header.
-const codec::Header &hello_message() {
-    // See: https://en.cppreference.com/w/cpp/language/value_initialization
-    // C++11 Value initialization
-    static codec::Header message{};
-    message.opcode = static_cast<char>(Opcode::hello);
-    return message;
+// hello opcode sent in response. This is the response header. The response
+// has the binary flag set if the responder accepts binary payloads.
+const codec::Header &hello_message(bool is_binary) {
+    static const codec::Header message{0, static_cast<char>(Opcode::hello), {0, 0}, 0, 0};
+    static const codec::Header binary_message{
+        codec::header_flag_binary, static_cast<char>(Opcode::hello), {0, 0}, 0, 0};
+    return is_binary ? binary_message : message;
 }
 
 OneError Connection::try_send_hello_message() {
@@ -277,14 +346,14 @@ OneError Connection::try_send_hello_message() {
     // will succeed since it is tiny and partial sends are rare edge cases in
     // general.
     if (stream.size() == 0) {
-        stream.put(&hello_message(), codec::header_size());
+        stream.put(&hello_message(_is_binary_negotiated), codec::header_size());
     }
 
     // Get remaining buffer.
-    const auto size = stream.size();
-    assert(size > 0);
     void *data = nullptr;
-    stream.peek(size, &data);
+    size_t size = 0;
+    stream.peek_read(&data, size);
+    assert(size > 0);
     assert(data != nullptr);
 
     // Send.
@@ -296,26 +365,29 @@ OneError Connection::try_send_hello_message() {
     if (sent == 0) return ONE_ERROR_CONNECTION_TRY_AGAIN;
 
     // Remove from send stream, check if finished.
-    stream.trim(sent);
+    stream.commit_read(sent);
     if (stream.size() > 0) return ONE_ERROR_CONNECTION_TRY_AGAIN;
 
     return ONE_ERROR_NONE;
 }
 
-OneError Connection::try_read_data_into_in_stream() {
+OneError Connection::try_read_data_into_in_stream(size_t &received) {
     assert(_socket && _socket->is_initialized());
 
-    constexpr size_t max_read_size = codec::header_size() + codec::payload_max_size();
-    static std::array<char, max_read_size> buffer;
-    const size_t available_size = _in_stream.capacity() - _in_stream.size();
-    const size_t read_size =
-        (max_read_size > available_size) ? available_size : max_read_size;
+    // Receive directly into the free space at the end of the stream. If the
+    // free space wraps around the end of the stream buffer, then only the first
+    // part is filled and the remainder is received on the next call.
+    void *data = nullptr;
+    size_t read_size = 0;
+    _in_stream.peek_write(&data, read_size);
 
-    size_t received = 0;
-    auto err = _socket->receive(buffer.data(), read_size, received);
-    if (is_error(err)) {
-        _status = Status::error;
-        return ONE_ERROR_CONNECTION_MESSAGE_RECEIVE_FAILED;
+    received = 0;
+    if (read_size > 0) {
+        auto err = _socket->receive(data, read_size, received);
+        if (is_error(err)) {
+            _status = Status::error;
+            return ONE_ERROR_CONNECTION_MESSAGE_RECEIVE_FAILED;
+        }
     }
 
 #ifdef ONE_ARCUS_CONNECTION_LOGGING
@@ -324,13 +396,14 @@ OneError Connection::try_read_data_into_in_stream() {
     });
 #endif
 
-    if (received > _in_stream.capacity() - _in_stream.size()) {
+    if (received > read_size) {
         _status = Status::error;
         return ONE_ERROR_CONNECTION_READ_TOO_BIG_FOR_STREAM;
     }
 
-    // Buffer bytes read.
-    _in_stream.put(buffer.data(), received);
+    // Add the received bytes to the stream.
+    _in_stream.commit_write(received);
+    _stats->bytes_in.add(received);
     if (_in_stream.size() < codec::header_size()) {
 #ifdef ONE_ARCUS_CONNECTION_LOGGING
         log(*_socket, [&](OStringStream &stream) {
@@ -345,18 +418,28 @@ OneError Connection::try_read_data_into_in_stream() {
 
 OneError Connection::try_read_message_from_in_stream(codec::Header &header,
                                                      Message &message) {
-    const size_t in_stream_size = _in_stream.size();
-    if (in_stream_size < codec::header_size())
+    if (_in_stream.size() < codec::header_size())
         return ONE_ERROR_CONNECTION_TRY_AGAIN;  // Nothing to read.
 
-    // Get a pointer to the entire input stream.
+    // Get a pointer to the readable part of the input stream.
     void *data = nullptr;
-    _in_stream.peek(in_stream_size, &data);
+    size_t length = 0;
+    _in_stream.peek_read(&data, length);
     assert(data != nullptr);
 
-    // Attempt to read a message from it.
+    // Read the header first, to know whether the payload needs decoding.
     size_t size_read = 0;
-    auto err = codec::data_to_message(data, in_stream_size, size_read, header, message);
+    auto err = codec::data_to_message_header(data, length, size_read, header);
+    if ((err == ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_HEADER ||
+         err == ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_PAYLOAD) &&
+        length < _in_stream.size()) {
+        // The message wraps around the end of the stream buffer. This only
+        // happens once per pass through the buffer, so make the stream
+        // contiguous and try again.
+        _in_stream.linearize();
+        _in_stream.peek_read(&data, length);
+        err = codec::data_to_message_header(data, length, size_read, header);
+    }
     if (is_error(err)) {
         if (err == ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_PAYLOAD) {
             // More reading is needed to be able to read the entire payload.
@@ -364,7 +447,26 @@ OneError Connection::try_read_message_from_in_stream(codec::Header &header,
         }
         return err;
     }
-    _in_stream.trim(size_read);
+
+    // Internal messages are consumed by the connection from their header
+    // alone, skip decoding the payload. The message is left untouched.
+    if (is_opcode_internal(static_cast<Opcode>(header.opcode))) {
+        _in_stream.commit_read(size_read);
+        _stats->messages_in.add(1);
+        return ONE_ERROR_NONE;
+    }
+
+    if ((header.flags & codec::header_flag_binary) && !_is_binary_negotiated) {
+        return ONE_ERROR_CONNECTION_BINARY_PAYLOAD_NOT_NEGOTIATED;
+    }
+
+    {
+        ScopedStatTimer timer(_stats->decode_time);
+        err = codec::data_to_message(data, length, size_read, header, message);
+    }
+    if (is_error(err)) return err;
+    _in_stream.commit_read(size_read);
+    _stats->messages_in.add(1);
 
 #ifdef ONE_ARCUS_CONNECTION_LOGGING
     log(*_socket, [&](OStringStream &stream) {
@@ -376,7 +478,8 @@ OneError Connection::try_read_message_from_in_stream(codec::Header &header,
 }
 
 OneError Connection::try_receive_hello_message() {
-    auto err = try_read_data_into_in_stream();
+    size_t received = 0;
+    auto err = try_read_data_into_in_stream(received);
     if (is_error(err)) return err;
 
     // See: https://en.cppreference.com/w/cpp/language/value_initialization
@@ -386,10 +489,15 @@ OneError Connection::try_receive_hello_message() {
     err = try_read_message_from_in_stream(header, message);
     if (is_error(err)) return err;
 
-    if (std::memcmp(&header, &hello_message(), codec::header_size()) != 0)
-        return ONE_ERROR_CONNECTION_HELLO_MESSAGE_REPLY_INVALID;
-    if (!message.payload().is_empty())
+    // A responder that does not support binary payloads replies with the
+    // plain hello message, even if binary was advertised. The header length
+    // is compared too, so the payload is empty.
+    if (_is_binary_supported &&
+        std::memcmp(&header, &hello_message(true), codec::header_size()) == 0) {
+        _is_binary_negotiated = true;
+    } else if (std::memcmp(&header, &hello_message(false), codec::header_size()) != 0) {
         return ONE_ERROR_CONNECTION_HELLO_MESSAGE_REPLY_INVALID;
+    }
     return ONE_ERROR_NONE;
 }
 
@@ -463,13 +571,14 @@ OneError Connection::process_incoming_messages() {
     // See: https://en.cppreference.com/w/cpp/language/value_initialization
     // C++11 Value initialization
     codec::Header header{};
-    Message message;
+    Message &message = _incoming_message;
     auto err = ONE_ERROR_NONE;
+    size_t received = 0;
 
     // Attempts to get data to process from the socket. Sets the above error if an error
     // is encountered.
     auto get_data_and_continue = [&]() -> bool {
-        err = try_read_data_into_in_stream();
+        err = try_read_data_into_in_stream(received);
         if (err == ONE_ERROR_CONNECTION_TRY_AGAIN) {
             err = ONE_ERROR_NONE;
             return false;
@@ -497,10 +606,14 @@ OneError Connection::process_incoming_messages() {
     };
 
     while (get_data_and_continue()) {
+        bool has_read_message = false;
         while (read_message_and_continue()) {
-            // Skip health messages, they are consumed internally and do not
-            // make it to the queue for public consumption.
-            if (message.code() == Opcode::health) {
+            has_read_message = true;
+
+            // Skip internal messages, such as health, they are consumed by
+            // the connection and do not make it to the queue for public
+            // consumption. Their payload is not decoded.
+            if (is_opcode_internal(static_cast<Opcode>(header.opcode))) {
                 continue;
             }
 
@@ -508,10 +621,17 @@ OneError Connection::process_incoming_messages() {
                 return ONE_ERROR_CONNECTION_INCOMING_QUEUE_INSUFFICIENT_SPACE;
             }
 
-            // Store in incoming queue for consumption.
-            _incoming_messages.push(message);
+            // Move into the incoming queue for consumption. The message
+            // receives the memory of the queue slot for the next parse.
+            _incoming_messages.push(std::move(message));
+            _stats->incoming_queue_peak.raise_to(_incoming_messages.size());
         }
         if (is_error(err)) break;
+
+        // Without new data nor room made in the stream, the rest of a partial
+        // message is read by a later update. The socket may not even try to
+        // receive before then, when the poller reported it as not readable.
+        if (received == 0 && !has_read_message) break;
     }
 
     if (is_error(err)) _status = Status::error;
@@ -522,96 +642,121 @@ OneError Connection::process_incoming_messages() {
 OneError Connection::process_outgoing_messages() {
     assert(_socket && _socket->is_initialized());
 
-    // Util to attempt to send all pending data in the buffered outgoing data
-    // stream.
-    auto send_pending_data = [&]() -> OneError {
-        size_t size = _out_stream.size();
-        if (size == 0) return ONE_ERROR_NONE;
-
-        // Check is socket is connected and ready.
-        bool can_send = false;
-        auto err = _socket->ready_for_send(0.f, can_send);
-        if (is_error(err)) return err;
-        if (!can_send) return ONE_ERROR_NONE;
-
-        // Try to send pending data.
-        void *data;
-        _out_stream.peek(size, &data);
-        size_t sent = 0;
-        err = _socket->send(data, size, sent);
-        if (err == ONE_ERROR_CONNECTION_TRY_AGAIN) return ONE_ERROR_NONE;
-        if (is_error(err)) return err;
-
-        _out_stream.trim(size);
-
-#ifdef ONE_ARCUS_CONNECTION_LOGGING
-        log(*_socket,
-            [&](OStringStream &stream) { stream << "connection sent data: " << sent; });
-#endif
-
-        return ONE_ERROR_NONE;
-    };
-
-    // Send from outgoing buffer if any previous messages are not finished
-    // sending.
-    auto err = send_pending_data();
-    if (is_error(err)) return err;
-
 #ifdef ONE_ARCUS_CONNECTION_LOGGING
     log(*_socket, [&](OStringStream &stream) {
         stream << "processing outgoing messages: " << _outgoing_messages.size();
     });
 #endif
 
-    // Attempt to send all pending messages.
-    while (_outgoing_messages.size() > 0) {
-        // Convert to data payload and add to outgoing buffer.
-        auto message = _outgoing_messages.pop();
+    auto fail = [&](OneError err) {
+        _status = Status::error;
+        return err;
+    };
 
-        auto fail = [&](OneError err) {
-            _status = Status::error;
-            return err;
-        };
+    // Encode all queued messages before sending, so that everything pending is
+    // sent with a single system call. Only if the stream was too full to hold
+    // all messages, and sending emptied it, is another pass made.
+    while (true) {
+        auto err = encode_outgoing_messages();
+        if (is_error(err)) return fail(err);
 
-        size_t message_size = 0;
-        static uint32_t packet_id = 1;
-        static std::array<char, codec::header_size() + codec::payload_max_size()>
-            out_message_buffer;
-        err =
-            codec::message_to_data(packet_id, message, message_size, out_message_buffer);
+        const size_t pending = _out_stream.size();
+        if (pending == 0) return ONE_ERROR_NONE;
 
-        if (is_error(err)) {
-            return fail(err);
-        }
+        size_t sent = 0;
+        err = send_out_stream(sent);
+        if (is_error(err)) return fail(err);
 
-        const size_t max_size = _out_stream.capacity() - _out_stream.size();
+        if (sent < pending || _outgoing_messages.size() == 0) return ONE_ERROR_NONE;
+    }
+}
 
-        // If it doesn't fit, then put the the connection into an error state.
-        if (message_size > max_size) {
-            return fail(ONE_ERROR_CONNECTION_OUT_MESSAGE_TOO_BIG_FOR_STREAM);
+OneError Connection::encode_outgoing_messages() {
+    ScopedStatTimer timer(_stats->encode_time);
+    while (_outgoing_messages.size() > 0) {
+        // The message is only removed from the queue once it is added to the
+        // outgoing stream.
+        Message &message = *_outgoing_messages.peek();
+
+        // Encode the message directly into the free space of the outgoing
+        // stream.
+        void *data = nullptr;
+        size_t data_size = 0;
+        _out_stream.peek_write(&data, data_size);
+        size_t message_size = 0;
+        const auto encoding = _is_binary_negotiated ? codec::PayloadEncoding::binary
+                                                    : codec::PayloadEncoding::json;
+        auto err = codec::message_to_data(_packet_id, message, data, data_size,
+                                          message_size, encoding);
+        if (err == ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE &&
+            data_size < _out_stream.free_size()) {
+            // The free space wraps around the end of the stream buffer. Make
+            // it contiguous and try again.
+            _out_stream.linearize();
+            _out_stream.peek_write(&data, data_size);
+            err = codec::message_to_data(_packet_id, message, data, data_size,
+                                         message_size, encoding);
         }
-
-        _out_stream.put(out_message_buffer.data(), message_size);
-
-        // Incrementing packet_id only after the message has been queued.
-        ++packet_id;
-
-        err = send_pending_data();
-        if (err == ONE_ERROR_CONNECTION_TRY_AGAIN) return ONE_ERROR_NONE;
-        if (is_error(err)) {
-            return fail(err);
+        if (err == ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE) {
+            // If it doesn't fit in an empty stream then it never will.
+            // Otherwise keep the message queued until the pending data is
+            // sent.
+            if (_out_stream.size() == 0) {
+                return ONE_ERROR_CONNECTION_OUT_MESSAGE_TOO_BIG_FOR_STREAM;
+            }
+            return ONE_ERROR_NONE;
         }
+        if (is_error(err)) return err;
+
+        _out_stream.commit_write(message_size);
 
 #ifdef ONE_ARCUS_CONNECTION_LOGGING
         log(*_socket, [&](OStringStream &stream) {
-            stream << "connection sent message opcode: " << (int)message.code();
+            stream << "connection encoded message opcode: " << (int)message.code();
             stream << "message payload" << message.payload().to_json();
         });
 #endif
+
+        _outgoing_messages.pop();
+        _stats->messages_out.add(1);
+
+        // Incrementing packet_id only after the message has been queued.
+        ++_packet_id;
     }
 
     return ONE_ERROR_NONE;
 }
 
+OneError Connection::send_out_stream(size_t &sent) {
+    sent = 0;
+
+    // Check is socket is connected and ready.
+    bool can_send = false;
+    auto err = _socket->ready_for_send(0.f, can_send);
+    if (is_error(err)) return err;
+    if (!can_send) return ONE_ERROR_NONE;
+
+    // The pending data may wrap around the end of the stream buffer, send both
+    // parts at once.
+    void *first = nullptr;
+    size_t first_size = 0;
+    void *second = nullptr;
+    size_t second_size = 0;
+    _out_stream.peek_read(&first, first_size, &second, second_size);
+    err = _socket->send(first, first_size, second, second_size, sent);
+    if (is_error(err)) return err;
+
+    // Only drop what was actually sent, the rest is sent on the next update.
+    _out_stream.commit_read(sent);
+    _stats->bytes_out.add(sent);
+
+#ifdef ONE_ARCUS_CONNECTION_LOGGING
+    log(*_socket,
+        [&](OStringStream &stream) { stream << "connection sent data: " << sent; });
+#endif
+
+    return ONE_ERROR_NONE;
+}
+
 }  // namespace one
 }  // namespace i3d
@@ -1,14 +1,17 @@
 #pragma once
 
+#include <stdint.h>
 #include <functional>
 #include <vector>
 
 #include <one/arcus/error.h>
 #include <one/arcus/c_platform.h>
-#include <one/arcus/internal/accumulator.h>
+#include <one/arcus/internal/circular_buffer.h>
 #include <one/arcus/internal/health.h>
 #include <one/arcus/internal/ring.h>
+#include <one/arcus/internal/stats.h>
 #include <one/arcus/internal/time.h>
+#include <one/arcus/message.h>
 
 namespace i3d {
 namespace one {
@@ -17,7 +20,6 @@ namespace codec {
 struct Header;
 }
 class Socket;
-class Message;
 template <typename T>
 class RingBuffer;
 
@@ -66,6 +68,15 @@ public:
     // Must be called after init, before updating.
     OneError initiate_handshake();
 
+    // Sets whether this side supports binary message payloads, see
+    // codec::binary_hello. The initiator only advertises binary payloads if
+    // set, so it must not be set on an initiator whose peer may be an older
+    // SDK. Payloads are sent binary once both sides support it. Must be
+    // called before init, and persists across shutdown.
+    void set_binary_payloads_supported(bool is_supported);
+    // Whether the handshake negotiated binary payloads.
+    bool is_binary_negotiated() const;
+
     // Update process incoming and outgoing messges. It attempts to read
     // all incoming messages that are available. It attempts to send all
     // queued outgoing messages. Must be called after init.
@@ -88,6 +99,9 @@ public:
     // call fails with ONE_ERROR_INSUFFICIENT_SPACE and the queue is not
     // modified. Must be called after init.
     OneError add_outgoing(const Message &message);
+    // Same as above, but moves the message into the queue instead of copying
+    // it.
+    OneError add_outgoing(Message &&message);
 
     // The number of incoming messages available for pop. Must be called after
     // init.
@@ -103,6 +117,31 @@ public:
     OneError remove_incoming(
         std::function<OneError(const Message &message)> read_callback);
 
+    // Removes a message from the incoming message queue, moving it into the
+    // given message. Returns ONE_ERROR_CONNECTION_QUEUE_EMPTY if there is no
+    // message to pop. Must be called after init.
+    OneError pop_incoming(Message &message);
+
+    // Counters of the connection since construction, kept across shutdown.
+    // Updated by the thread using the connection, readable from any thread.
+    // Times are in nanoseconds.
+    struct Stats {
+        StatCounter messages_in;  // Including internal messages.
+        StatCounter messages_out;
+        StatCounter bytes_in;
+        StatCounter bytes_out;
+        StatCounter update_time;
+        StatCounter encode_time;
+        StatCounter decode_time;
+        StatCounter incoming_queue_peak;
+        StatCounter outgoing_queue_peak;
+    };
+    const Stats &stats() const;
+    // Keeps the counters in the given stats, which must outlive the connection,
+    // instead of its own, e.g. for the owner to read them without the
+    // connection.
+    void set_stats(Stats &stats);
+
 private:
     Connection() = delete;
 
@@ -111,14 +150,22 @@ private:
     // the incoming message queue.
     OneError process_incoming_messages();
     // Sends all outgoing messages in the queue as long as the socket is ready
-    // for sending.
+    // for sending. The messages are batched into one send per update.
     OneError process_outgoing_messages();
 
     OneError process_health();
 
     // Message helpers.
-    OneError try_read_data_into_in_stream();
+    // Sets received to the bytes added to the in stream, which is 0 when the
+    // socket has nothing new.
+    OneError try_read_data_into_in_stream(size_t &received);
     OneError try_read_message_from_in_stream(codec::Header &header, Message &message);
+    // Encodes queued outgoing messages into the out stream until either is
+    // full or empty.
+    OneError encode_outgoing_messages();
+    // Sends as much of the out stream as the socket accepts, setting sent to
+    // the number of bytes sent and removed from the stream.
+    OneError send_out_stream(size_t &sent);
 
     // Handshake helpers.
     OneError ensure_nothing_received();
@@ -130,14 +177,26 @@ private:
     Socket *_socket;
     Status _status;
 
-    Accumulator _in_stream;
-    Accumulator _out_stream;
+    bool _is_binary_supported;
+    bool _is_binary_negotiated;
 
+    CircularBuffer _in_stream;
+    CircularBuffer _out_stream;
+    uint32_t _packet_id;  // Id of the next message added to the outgoing stream.
+
+    // Every incoming message is parsed into this one before being queued, so
+    // that its memory is reused.
+    Message _incoming_message;
+    // The message being passed to remove_incoming's callback.
+    Message _removed_message;
     Ring<Message> _incoming_messages;
     Ring<Message> _outgoing_messages;
 
     IntervalTimer _handshake_timer;
     HealthChecker _health_checker;
+
+    Stats _own_stats;
+    Stats *_stats;
 };
 
 }  // namespace one
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <one/arcus/error.h>
+#include <one/arcus/internal/messages.h>
+#include <one/arcus/message.h>
+#include <one/arcus/opcode.h>
+
+namespace i3d {
+namespace one {
+
+//------------------------------------------------------------------------------
+// Opcode traits.
+
+// Compile-time description of a message with a payload: the parameters read
+// from the payload, their validation and the callback notified of them. The
+// callbacks of the messages received by the server take their array or object
+// as a void pointer, as in the C API.
+template <Opcode code>
+struct OpcodeTraits;
+
+template <>
+struct OpcodeTraits<Opcode::soft_stop> {
+    using Params = params::SoftStopRequest;
+    using Callback = void (*)(void *, int);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::soft_stop(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, params._timeout);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::allocated> {
+    using Params = params::AllocatedRequest;
+    using Callback = void (*)(void *, void *);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::allocated(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, &params._data);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::metadata> {
+    using Params = params::MetaDataRequest;
+    using Callback = void (*)(void *, void *);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::metadata(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, &params._data);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::reverse_metadata> {
+    using Params = params::ReverseMetaDataResponse;
+    using Callback = void (*)(void *, Array *);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::reverse_metadata(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, &params._data);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::live_state> {
+    using Params = params::LiveStateResponse;
+    using Callback = void (*)(void *, int, int, const String &, const String &,
+                              const String &, const String &);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::live_state(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, params._players, params._max_players, params._name,
+                 params._map, params._mode, params._version);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::host_information> {
+    using Params = params::HostInformationResponse;
+    using Callback = void (*)(void *, void *);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::host_information(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, &params._host_information);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::application_instance_information> {
+    using Params = params::ApplicationInstanceInformationResponse;
+    using Callback = void (*)(void *, void *);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::application_instance_information(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, &params._application_instance_information);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::application_instance_status> {
+    using Params = params::ApplicationInstanceSetStatusRequest;
+    using Callback = void (*)(void *, int);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::application_instance_status(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, params._status);
+    }
+};
+
+template <>
+struct OpcodeTraits<Opcode::custom_command> {
+    using Params = params::CustomCommandRequest;
+    using Callback = void (*)(void *, void *);
+    static OneError validate(const Message &message, Params &params) {
+        return validation::custom_command(message, params);
+    }
+    static void call(Callback callback, void *userdata, Params &params) {
+        callback(userdata, &params._data);
+    }
+};
+
+// Validates the payload of a message with the given opcode.
+template <Opcode code>
+OneError validate(const Message &message) {
+    typename OpcodeTraits<code>::Params params;
+    return OpcodeTraits<code>::validate(message, params);
+}
+
+//------------------------------------------------------------------------------
+// Outgoing validation.
+
+// A compile-time list of opcodes, e.g. those one side of a connection sends.
+template <Opcode... codes>
+struct OpcodeList;
+
+template <>
+struct OpcodeList<> {
+    static OneError validate(const Message &, bool &is_listed) {
+        is_listed = false;
+        return ONE_ERROR_NONE;
+    }
+};
+
+template <Opcode code, Opcode... codes>
+struct OpcodeList<code, codes...> {
+    // Validates the message's payload if its opcode is listed. Sets is_listed
+    // to whether it is.
+    static OneError validate(const Message &message, bool &is_listed) {
+        if (message.code() == code) {
+            is_listed = true;
+            return one::validate<code>(message);
+        }
+        return OpcodeList<codes...>::validate(message, is_listed);
+    }
+};
+
+//------------------------------------------------------------------------------
+// Incoming dispatch.
+
+// Opcode-indexed callbacks of incoming messages. Dispatching a message is a
+// single indirect call to the opcode's handler, which validates the payload
+// and calls the callback with the parameters.
+class DispatchTable final {
+public:
+    DispatchTable() {
+        clear();
+    }
+
+    template <Opcode code>
+    void set(typename OpcodeTraits<code>::Callback callback, void *userdata) {
+        static_assert(static_cast<size_t>(code) < size, "opcode must fit the table");
+        auto &handler = _handlers[static_cast<size_t>(code)];
+        handler.invoke = &invoke<code>;
+        handler.callback = reinterpret_cast<AnyCallback>(callback);
+        handler.userdata = userdata;
+    }
+
+    void clear() {
+        for (auto &handler : _handlers) {
+            handler = Handler{nullptr, nullptr, nullptr};
+        }
+    }
+
+    // Messages of opcodes without a callback are ignored.
+    OneError dispatch(const Message &message) const {
+        const auto index = static_cast<size_t>(message.code());
+        if (size <= index) {
+            return ONE_ERROR_NONE;
+        }
+
+        const auto &handler = _handlers[index];
+        if (handler.callback == nullptr) {
+            return ONE_ERROR_NONE;
+        }
+
+        return handler.invoke(message, handler.callback, handler.userdata);
+    }
+
+private:
+    // Stands for any callback type, converted back to the opcode's callback
+    // type by invoke.
+    using AnyCallback = void (*)();
+
+    struct Handler {
+        OneError (*invoke)(const Message &, AnyCallback, void *);
+        AnyCallback callback;
+        void *userdata;
+    };
+
+    template <Opcode code>
+    static OneError invoke(const Message &message, AnyCallback callback, void *userdata) {
+        using Traits = OpcodeTraits<code>;
+        typename Traits::Params params;
+        const auto err = Traits::validate(message, params);
+        if (is_error(err)) {
+            return err;
+        }
+
+        Traits::call(reinterpret_cast<typename Traits::Callback>(callback), userdata,
+                     params);
+        return ONE_ERROR_NONE;
+    }
+
+    // Opcodes are a byte in the message header.
+    static constexpr size_t size = 256;
+    Handler _handlers[size];
+};
+
+}  // namespace one
+}  // namespace i3d
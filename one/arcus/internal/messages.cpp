@@ -213,159 +213,5 @@ OneError custom_command(const Message &message, params::CustomCommandRequest &pa
 
 }  // namespace validation
 
-namespace invocation {
-
-OneError soft_stop(const Message &message, std::function<void(void *, int)> callback,
-                   void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::SoftStopRequest params;
-    const auto err = validation::soft_stop(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, params._timeout);
-    return ONE_ERROR_NONE;
-}
-
-OneError allocated(const Message &message, std::function<void(void *, Array *)> callback,
-                   void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::AllocatedRequest params;
-    const auto err = validation::allocated(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, &params._data);
-    return ONE_ERROR_NONE;
-}
-
-OneError metadata(const Message &message, std::function<void(void *, Array *)> callback,
-                  void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::MetaDataRequest params;
-    const auto err = validation::metadata(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, &params._data);
-    return ONE_ERROR_NONE;
-}
-
-OneError reverse_metadata(const Message &message,
-                          std::function<void(void *, Array *)> callback, void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::ReverseMetaDataResponse params;
-    const auto err = validation::reverse_metadata(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, &params._data);
-    return ONE_ERROR_NONE;
-}
-
-OneError live_state(const Message &message,
-                    std::function<void(void *, int, int, const String &, const String &,
-                                       const String &, const String &)>
-                        callback,
-                    void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::LiveStateResponse params;
-    const auto err = validation::live_state(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, params._players, params._max_players, params._name, params._map,
-             params._mode, params._version);
-    return ONE_ERROR_NONE;
-}
-
-OneError host_information(const Message &message,
-                          std::function<void(void *, Object *)> callback, void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::HostInformationResponse params;
-    const auto err = validation::host_information(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, &params._host_information);
-    return ONE_ERROR_NONE;
-}
-
-OneError application_instance_information(const Message &message,
-                                          std::function<void(void *, Object *)> callback,
-                                          void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::ApplicationInstanceInformationResponse params;
-    const auto err = validation::application_instance_information(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, &params._application_instance_information);
-    return ONE_ERROR_NONE;
-}
-
-OneError application_instance_status(const Message &message,
-                                     std::function<void(void *, int)> callback,
-                                     void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::ApplicationInstanceSetStatusRequest params;
-    const auto err = validation::application_instance_status(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, params._status);
-    return ONE_ERROR_NONE;
-}
-
-OneError custom_command(const Message &message,
-                        std::function<void(void *, Array *)> callback, void *data) {
-    if (callback == nullptr) {
-        return ONE_ERROR_MESSAGE_CALLBACK_IS_NULLPTR;
-    }
-
-    params::CustomCommandRequest params;
-    const auto err = validation::custom_command(message, params);
-    if (is_error(err)) {
-        return err;
-    }
-
-    callback(data, &params._data);
-    return ONE_ERROR_NONE;
-}
-
-}  // namespace invocation
-
 }  // namespace one
 }  // namespace i3d
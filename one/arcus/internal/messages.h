@@ -5,7 +5,6 @@
 #include <one/arcus/message.h>
 #include <one/arcus/object.h>
 
-#include <functional>
 
 namespace i3d {
 namespace one {
@@ -73,41 +72,5 @@ OneError application_instance_status(const Message &message,
 OneError custom_command(const Message &message, params::CustomCommandRequest &params);
 }  // namespace validation
 
-namespace invocation {
-
-OneError soft_stop(const Message &message, std::function<void(void *, int)> callback,
-                   void *data);
-
-OneError allocated(const Message &message, std::function<void(void *, Array *)> callback,
-                   void *data);
-
-OneError metadata(const Message &message, std::function<void(void *, Array *)> callback,
-                  void *data);
-
-OneError reverse_metadata(const Message &message,
-                          std::function<void(void *, Array *)> callback, void *data);
-
-OneError live_state(const Message &message,
-                    std::function<void(void *, int, int, const String &, const String &,
-                                       const String &, const String &)>
-                        callback,
-                    void *data);
-
-OneError host_information(const Message &message,
-                          std::function<void(void *, Object *)> callback, void *data);
-
-OneError application_instance_information(const Message &message,
-                                          std::function<void(void *, Object *)> callback,
-                                          void *data);
-
-OneError application_instance_status(const Message &message,
-                                     std::function<void(void *, int)> callback,
-                                     void *data);
-
-OneError custom_command(const Message &message,
-                        std::function<void(void *, Array *)> callback, void *data);
-
-}  // namespace invocation
-
 }  // namespace one
 }  // namespace i3d
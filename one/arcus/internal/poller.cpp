@@ -0,0 +1,117 @@
+#include <one/arcus/internal/poller.h>
+
+#include <assert.h>
+
+#include <one/arcus/internal/socket.h>
+
+#ifdef ONE_ARCUS_EPOLL
+    #include <sys/epoll.h>
+    #include <unistd.h>
+#endif
+
+namespace i3d {
+namespace one {
+
+Poller::Poller() : _poller(-1) {}
+
+Poller::~Poller() {
+    shutdown();
+}
+
+bool Poller::is_initialized() const {
+    return _poller >= 0;
+}
+
+#ifdef ONE_ARCUS_EPOLL
+
+OneError Poller::init() {
+    if (is_initialized()) return ONE_ERROR_NONE;
+
+    _poller = ::epoll_create1(EPOLL_CLOEXEC);
+    if (_poller < 0) return ONE_ERROR_SOCKET_POLLER_CREATE_FAILED;
+    return ONE_ERROR_NONE;
+}
+
+void Poller::shutdown() {
+    if (!is_initialized()) return;
+
+    ::close(_poller);
+    _poller = -1;
+}
+
+OneError Poller::add(Socket &socket) {
+    assert(socket.is_initialized());
+    assert(socket._poller == nullptr);
+    if (!is_initialized()) return ONE_ERROR_SOCKET_POLLER_UNAVAILABLE;
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = &socket;
+    if (::epoll_ctl(_poller, EPOLL_CTL_ADD, socket._socket, &event) < 0) {
+        return ONE_ERROR_SOCKET_POLLER_ADD_FAILED;
+    }
+
+    socket._poller = this;
+    socket._is_readable = true;
+    socket._is_writable = true;
+    return ONE_ERROR_NONE;
+}
+
+void Poller::remove(Socket &socket) {
+    assert(socket._poller == this);
+
+    if (socket.is_initialized()) {
+        ::epoll_ctl(_poller, EPOLL_CTL_DEL, socket._socket, nullptr);
+    }
+    socket._poller = nullptr;
+}
+
+OneError Poller::update() {
+    if (!is_initialized()) return ONE_ERROR_SOCKET_POLLER_UNAVAILABLE;
+
+    // A server has at most a listen and a client socket, so a few events
+    // suffice. More are collected by the following calls.
+    constexpr int max_events = 8;
+    epoll_event events[max_events];
+    int count = max_events;
+    while (count == max_events) {
+        count = ::epoll_wait(_poller, events, max_events, 0);
+        if (count < 0) return ONE_ERROR_SOCKET_POLLER_WAIT_FAILED;
+
+        for (int i = 0; i < count; ++i) {
+            auto socket = reinterpret_cast<Socket *>(events[i].data.ptr);
+            const auto flags = events[i].events;
+            // Errors and hang ups are surfaced by the next socket operation.
+            if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                socket->_is_readable = true;
+            }
+            if (flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+                socket->_is_writable = true;
+            }
+        }
+    }
+    return ONE_ERROR_NONE;
+}
+
+#else
+
+OneError Poller::init() {
+    return ONE_ERROR_SOCKET_POLLER_UNAVAILABLE;
+}
+
+void Poller::shutdown() {}
+
+OneError Poller::add(Socket &) {
+    return ONE_ERROR_SOCKET_POLLER_UNAVAILABLE;
+}
+
+void Poller::remove(Socket &) {}
+
+OneError Poller::update() {
+    return ONE_ERROR_SOCKET_POLLER_UNAVAILABLE;
+}
+
+#endif  // ONE_ARCUS_EPOLL
+
+}  // namespace one
+}  // namespace i3d
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <one/arcus/c_platform.h>
+#include <one/arcus/error.h>
+
+// The poller is backed by epoll on Linux. Define ONE_ARCUS_NO_EPOLL to build
+// without it, in which case sockets always fall back to select.
+#if defined(ONE_LINUX) && !defined(ONE_ARCUS_NO_EPOLL)
+    #define ONE_ARCUS_EPOLL
+#endif
+
+namespace i3d {
+namespace one {
+
+class Socket;
+
+// Poller tracks whether its sockets are ready for reading and sending, so that
+// a single non-blocking call per update collects the readiness of all of
+// them, instead of a select call per socket per check.
+//
+// Sockets are watched edge-triggered. A socket is marked ready when the
+// system reports a change, and stays ready until one of its operations finds
+// it would block, see Socket. Ready checks, receives, sends and accepts on a
+// socket that is not ready return immediately without a system call, so that
+// updating an idle socket costs only the shared poll.
+//
+// Only available on Linux, init fails with ONE_ERROR_SOCKET_POLLER_UNAVAILABLE
+// elsewhere and the caller should keep using the sockets unpolled.
+class Poller final {
+public:
+    Poller();
+    ~Poller();
+
+    Poller(const Poller &) = delete;
+    Poller &operator=(const Poller &) = delete;
+
+    OneError init();
+    bool is_initialized() const;
+
+    // Closes the poller. All sockets must have been removed first.
+    void shutdown();
+
+    // Starts tracking the readiness of the initialized socket. The socket is
+    // considered ready for both reading and sending until it finds otherwise.
+    // The socket is removed automatically when it is closed.
+    OneError add(Socket &socket);
+
+    // Stops tracking the socket, which goes back to using select.
+    void remove(Socket &socket);
+
+    // Collects the readiness changes of all added sockets, without blocking.
+    OneError update();
+
+private:
+    int _poller;
+};
+
+}  // namespace one
+}  // namespace i3d
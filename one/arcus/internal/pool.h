@@ -0,0 +1,98 @@
+#pragma once
+
+#include <assert.h>
+#include <mutex>
+
+#include <one/arcus/allocator.h>
+
+namespace i3d {
+namespace one {
+
+// Pool recycles instances of T, so that creating and destroying them in a
+// steady state does not allocate. Released instances are cleared, keeping
+// the memory they reserved, and up to capacity of them are kept for the next
+// acquire. T must provide clear. Thread-safe.
+template <typename T>
+class Pool final {
+public:
+    Pool() : _instances(nullptr), _capacity(0), _size(0) {}
+    ~Pool() {
+        set_capacity(0);
+    }
+
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    // Sets the maximum number of kept instances. Kept instances above the new
+    // capacity are destroyed, so 0 releases all memory held by the pool.
+    void set_capacity(size_t capacity) {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        while (_size > capacity) {
+            allocator::destroy<T>(_instances[--_size]);
+        }
+
+        T **instances = nullptr;
+        if (capacity > 0) {
+            instances = reinterpret_cast<T **>(allocator::alloc(sizeof(T *) * capacity));
+            assert(instances);
+            for (size_t i = 0; i < _size; ++i) {
+                instances[i] = _instances[i];
+            }
+        }
+        if (_instances != nullptr) {
+            allocator::free(_instances);
+        }
+        _instances = instances;
+        _capacity = capacity;
+    }
+
+    size_t capacity() const {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        return _capacity;
+    }
+
+    // The number of kept instances.
+    size_t size() const {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        return _size;
+    }
+
+    // Returns a kept instance, or a new one if none is kept. The instance must
+    // be given back via release.
+    T *acquire() {
+        {
+            const std::lock_guard<std::mutex> lock(_mutex);
+            if (_size > 0) {
+                return _instances[--_size];
+            }
+        }
+        return allocator::create<T>();
+    }
+
+    // Clears the instance and keeps it for reuse, or destroys it if the pool
+    // is full. Does nothing if instance is null.
+    void release(T *instance) {
+        if (instance == nullptr) {
+            return;
+        }
+
+        instance->clear();
+        {
+            const std::lock_guard<std::mutex> lock(_mutex);
+            if (_size < _capacity) {
+                _instances[_size++] = instance;
+                return;
+            }
+        }
+        allocator::destroy<T>(instance);
+    }
+
+private:
+    mutable std::mutex _mutex;
+    T **_instances;
+    size_t _capacity;
+    size_t _size;
+};
+
+}  // namespace one
+}  // namespace i3d
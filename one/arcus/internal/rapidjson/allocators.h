@@ -82,12 +82,22 @@ public:
             return NULL; // standardize to returning NULL.
     }
     void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
-        (void)originalSize;
         if (newSize == 0) {
             RAPIDJSON_FREE(originalPtr);
             return NULL;
         }
-        return RAPIDJSON_REALLOC(originalPtr, newSize);
+        // i3d::one change
+        // Grow with malloc and free only, so that all memory goes through the
+        // allocator alloc and free overrides, even without a realloc override.
+        //return RAPIDJSON_REALLOC(originalPtr, newSize);
+        if (originalPtr == NULL)
+            return RAPIDJSON_MALLOC(newSize);
+        void* newPtr = RAPIDJSON_MALLOC(newSize);
+        if (newPtr == NULL)
+            return NULL;
+        std::memcpy(newPtr, originalPtr, originalSize < newSize ? originalSize : newSize);
+        RAPIDJSON_FREE(originalPtr);
+        return newPtr;
     }
     static void Free(void *ptr) { RAPIDJSON_FREE(ptr); }
 };
@@ -666,6 +666,17 @@ RAPIDJSON_NAMESPACE_END
 #define RAPIDJSON_FREE(ptr) i3d::one::allocator::free(ptr)
 #endif
 
+// i3d::one change
+// Documents allocate from an arena that they reset when replaced as a whole,
+// instead of allocating every value separately.
+#include <one/arcus/internal/arena.h>
+#ifndef RAPIDJSON_DEFAULT_ALLOCATOR
+#define RAPIDJSON_DEFAULT_ALLOCATOR ::i3d::one::Arena
+#endif
+#ifndef RAPIDJSON_DEFAULT_STACK_ALLOCATOR
+#define RAPIDJSON_DEFAULT_STACK_ALLOCATOR ::i3d::one::Arena
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // new/delete
 
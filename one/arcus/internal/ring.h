@@ -1,6 +1,7 @@
 #pragma once
 
 #include <assert.h>
+#include <utility>
 
 #include <one/arcus/allocator.h>
 
@@ -41,9 +42,20 @@ public:
 
     void push(const T &val) {
         _buffer[_next] = val;
-        _next++;
-        if (_next >= _capacity) _next = 0;
-        if (_size < _capacity) _size++;
+        advance_next();
+    }
+
+    // Moves the value into the ring instead of copying it.
+    void push(T &&val) {
+        _buffer[_next] = std::move(val);
+        advance_next();
+    }
+
+    // Constructs a value from the given arguments and moves it into the ring.
+    template <class... Args>
+    void emplace(Args &&... args) {
+        _buffer[_next] = T(std::forward<Args>(args)...);
+        advance_next();
     }
 
     // Returns the last element, if any, or null if none.
@@ -67,7 +79,19 @@ public:
         return _buffer[prev_last];
     }
 
+    // Pops the oldest pushed value, moving it into val. Asserts if size is
+    // zero.
+    void pop(T &val) {
+        val = std::move(pop());
+    }
+
 private:
+    void advance_next() {
+        _next++;
+        if (_next >= _capacity) _next = 0;
+        if (_size < _capacity) _size++;
+    }
+
     T *_buffer;
 
     const size_t _capacity;
@@ -1,5 +1,6 @@
 #include <one/arcus/internal/socket.h>
 #include <one/arcus/c_platform.h>
+#include <one/arcus/internal/poller.h>
 
 #include <assert.h>
 #include <chrono>
@@ -13,6 +14,8 @@ typedef int socklen_t;
     #include <fcntl.h>
     #include <netinet/in.h>
     #include <sys/ioctl.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <unistd.h>
     #include <errno.h>
 
@@ -57,13 +60,17 @@ inline int last_error() {
 #endif
 }
 
-Socket::Socket() : _socket(INVALID_SOCKET) {}
+Socket::Socket()
+    : _socket(INVALID_SOCKET), _poller(nullptr), _is_readable(false), _is_writable(false) {}
 
-Socket::Socket(const Socket &other) : _socket(other._socket) {
+Socket::Socket(const Socket &other)
+    : _socket(other._socket), _poller(nullptr), _is_readable(false), _is_writable(false) {
+    assert(other._poller == nullptr);
     other._socket = INVALID_SOCKET;
 }
 
 void Socket::operator=(const Socket &other) {
+    assert(_poller == nullptr && other._poller == nullptr);
     _socket = other._socket;
     other._socket = INVALID_SOCKET;
 }
@@ -113,6 +120,10 @@ OneError Socket::init() {
 OneError Socket::close() {
     if (_socket == INVALID_SOCKET) return ONE_ERROR_NONE;
 
+    if (_poller != nullptr) {
+        _poller->remove(*this);
+    }
+
     // Read until nothing to read.
     char data[1024];
     while (true) {
@@ -202,12 +213,17 @@ OneError Socket::accept(Socket &client, String &ip, unsigned int &port) {
         return ONE_ERROR_SOCKET_ACCEPT_UNINITIALIZED;
     }
 
+    if (_poller != nullptr && !_is_readable) return ONE_ERROR_NONE;
+
     struct sockaddr addr;
     socklen_t addrLen = (socklen_t)sizeof(sockaddr);
     SOCKET socket = ::accept(_socket, &addr, &addrLen);
 
     // No client is attempting to connect.
-    if (socket == INVALID_SOCKET) return ONE_ERROR_NONE;
+    if (socket == INVALID_SOCKET) {
+        if (is_error_try_again(last_error())) _is_readable = false;
+        return ONE_ERROR_NONE;
+    }
 
     // Client received.
 
@@ -248,6 +264,11 @@ OneError Socket::ready_for_read(float timeout, bool &is_ready) {
     is_ready = false;
     if (is_initialized() == false) return ONE_ERROR_SOCKET_SELECT_UNINITIALIZED;
 
+    if (_poller != nullptr && timeout == 0.f) {
+        is_ready = _is_readable;
+        return ONE_ERROR_NONE;
+    }
+
     fd_set fds;
     FD_ZERO(&fds);
     FD_SET(_socket, &fds);
@@ -268,6 +289,11 @@ OneError Socket::ready_for_send(float timeout, bool &is_ready) {
     is_ready = false;
     if (is_initialized() == false) return ONE_ERROR_SOCKET_SELECT_UNINITIALIZED;
 
+    if (_poller != nullptr && timeout == 0.f) {
+        is_ready = _is_writable;
+        return ONE_ERROR_NONE;
+    }
+
     fd_set fds;
     FD_ZERO(&fds);
     FD_SET(_socket, &fds);
@@ -285,6 +311,9 @@ OneError Socket::ready_for_send(float timeout, bool &is_ready) {
 }
 
 OneError Socket::send(const void *data, size_t length, size_t &length_sent) {
+    length_sent = 0;
+    if (_poller != nullptr && !_is_writable) return ONE_ERROR_NONE;
+
 #if defined(ONE_WINDOWS)
     const auto result = ::send(_socket, (const char *)data, length, 0);
 #else
@@ -292,12 +321,60 @@ OneError Socket::send(const void *data, size_t length, size_t &length_sent) {
 #endif
     if (result >= 0) {
         length_sent = (size_t)result;
+        // A partial send means the send buffer is full.
+        if (length_sent < length) _is_writable = false;
         return ONE_ERROR_NONE;
     }
 
+    const auto err = last_error();
+    if (is_error_try_again(err)) {
+        _is_writable = false;
+        return ONE_ERROR_NONE;
+    }
+    return ONE_ERROR_SOCKET_SEND_FAILED;
+}
+
+OneError Socket::send(const void *first, size_t first_length, const void *second,
+                      size_t second_length, size_t &length_sent) {
+    if (second_length == 0) return send(first, first_length, length_sent);
+
     length_sent = 0;
+    if (_poller != nullptr && !_is_writable) return ONE_ERROR_NONE;
+
+    const size_t length = first_length + second_length;
+#if defined(ONE_WINDOWS)
+    WSABUF buffers[2];
+    buffers[0].buf = (char *)first;
+    buffers[0].len = (ULONG)first_length;
+    buffers[1].buf = (char *)second;
+    buffers[1].len = (ULONG)second_length;
+    DWORD sent = 0;
+    const auto result = ::WSASend(_socket, buffers, 2, &sent, 0, nullptr, nullptr);
+    if (result == 0) {
+        length_sent = (size_t)sent;
+#else
+    iovec buffers[2];
+    buffers[0].iov_base = const_cast<void *>(first);
+    buffers[0].iov_len = first_length;
+    buffers[1].iov_base = const_cast<void *>(second);
+    buffers[1].iov_len = second_length;
+    msghdr header{};
+    header.msg_iov = buffers;
+    header.msg_iovlen = 2;
+    const auto result = ::sendmsg(_socket, &header, MSG_NOSIGNAL);
+    if (result >= 0) {
+        length_sent = (size_t)result;
+#endif
+        // A partial send means the send buffer is full.
+        if (length_sent < length) _is_writable = false;
+        return ONE_ERROR_NONE;
+    }
+
     const auto err = last_error();
-    if (is_error_try_again(err)) return ONE_ERROR_NONE;
+    if (is_error_try_again(err)) {
+        _is_writable = false;
+        return ONE_ERROR_NONE;
+    }
     return ONE_ERROR_SOCKET_SEND_FAILED;
 }
 
@@ -314,15 +391,23 @@ OneError Socket::available(size_t &length) {
 }
 
 OneError Socket::receive(void *data, size_t length, size_t &length_received) {
+    length_received = 0;
+    if (_poller != nullptr && !_is_readable) return ONE_ERROR_NONE;
+
     const auto result = ::recv(_socket, (char *)data, length, 0);
     if (result >= 0) {
         length_received = (size_t)result;
+        // A partial receive means the receive buffer is drained. Nothing
+        // received means the connection was closed, keep reporting that.
+        if (0 < length_received && length_received < length) _is_readable = false;
         return ONE_ERROR_NONE;
     }
 
-    length_received = 0;
     const auto err = last_error();
-    if (is_error_try_again(err)) return ONE_ERROR_NONE;
+    if (is_error_try_again(err)) {
+        _is_readable = false;
+        return ONE_ERROR_NONE;
+    }
     return ONE_ERROR_SOCKET_RECEIVE_FAILED;
 }
 
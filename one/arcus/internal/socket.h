@@ -26,6 +26,8 @@ const int INVALID_SOCKET = -1;
 namespace i3d {
 namespace one {
 
+class Poller;
+
 // Must be called before using Socket. Safe to call multiple times. Calls to
 // init_socket_system must have matching calls to shutdown_socket_system.
 // The first init call does the initializing. Any calls after the first init
@@ -54,7 +56,7 @@ public:
     // Note that the system socket ownership is transferred when sockets are
     // copied or assigned. Be careful when using the socket in data structures,
     // if the socket is automatically copied during use, behavior may be
-    // undefined.
+    // undefined. Sockets added to a Poller must not be copied or assigned.
     explicit Socket(const Socket &other);
     void operator=(const Socket &other);
 
@@ -65,7 +67,7 @@ public:
         return _socket != INVALID_SOCKET;
     }
 
-    // Closes active socket, if active.
+    // Closes active socket, if active. Removes it from its Poller, if any.
     OneError close();
 
     //--------
@@ -103,9 +105,12 @@ public:
     // IO.
 
     // Sets is_ready to true if the socket is ready for reading (accept or receive).
+    // If the socket is added to a Poller and the timeout is zero, then the
+    // readiness tracked by the Poller is given without a system call.
     OneError ready_for_read(float timeout, bool &is_ready);
 
-    // Sets is_ready to true if the socket is ready for sending.
+    // Sets is_ready to true if the socket is ready for sending. Same as above
+    // if added to a Poller.
     OneError ready_for_send(float timeout, bool &is_ready);
 
     // Sends data on the socket, setting the given length_sent to the number of
@@ -114,6 +119,12 @@ public:
     // ONE_ERROR_NONE.
     OneError send(const void *data, size_t length, size_t &length_sent);
 
+    // Same as above, but sends the two given buffers one after the other with
+    // a single system call, as if they were one contiguous buffer. The second
+    // buffer may be empty.
+    OneError send(const void *first, size_t first_length, const void *second,
+                  size_t second_length, size_t &length_sent);
+
     // Puts number of bytes available for reading into the given length.
     OneError available(size_t &length);
 
@@ -126,10 +137,23 @@ public:
     // Error reporting.
     const char *last_error_text() const;
 
+    // The Poller the socket is added to, if any.
+    Poller *poller() const {
+        return _poller;
+    }
+
 private:
+    friend class Poller;
+
     mutable SOCKET _socket;  // Mutable so that the copy constructor and operator can take
                              // ownership of the system socket.
 
+    // Readiness tracked by the Poller, if added to one. Cleared by the
+    // operations that find the socket would block.
+    Poller *_poller;
+    bool _is_readable;
+    bool _is_writable;
+
 public:
     void set_last_error_text();
 
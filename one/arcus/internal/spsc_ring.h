@@ -0,0 +1,158 @@
+#pragma once
+
+#include <assert.h>
+#include <atomic>
+#include <utility>
+
+#include <one/arcus/allocator.h>
+
+namespace i3d {
+namespace one {
+
+// FIFO ring buffer with a fixed capacity, for passing values from one
+// producer thread to one consumer thread without locks. Each push and pop
+// completes in a bounded number of steps (wait-free). Unlike Ring, a push to
+// a full ring fails instead of overwriting the oldest value.
+//
+// Only one thread at a time may call the producer functions, and only one
+// thread at a time may call the consumer functions.
+template <typename T>
+class SpscRing final {
+public:
+    SpscRing(size_t capacity)
+        : _buffer(nullptr)
+        , _capacity(capacity)
+        , _head(0)
+        , _cached_tail(0)
+        , _tail(0)
+        , _cached_head(0) {
+        assert(_capacity > 0);
+        void *p = allocator::create_array<T>(_capacity);
+        assert(p);
+        _buffer = reinterpret_cast<T *>(p);
+    }
+    ~SpscRing() {
+        assert(_buffer);
+        allocator::destroy_array<T>(_buffer);
+        _buffer = nullptr;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    // The number of values pushed and not yet popped. Exact only when called
+    // from the producer or consumer thread while the other is idle.
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire) -
+               _head.load(std::memory_order_acquire);
+    }
+
+    //---------
+    // Producer.
+
+    // Returns the slot the next push writes to, or null if the ring is full.
+    // Filling the slot in place reuses the memory of the value it held. The
+    // slot is only pushed by commit.
+    T *reserve() {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cached_head == _capacity) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _cached_head == _capacity) {
+                return nullptr;
+            }
+        }
+        return &_buffer[tail % _capacity];
+    }
+
+    // Pushes the slot returned by the last reserve.
+    void commit() {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    // Copies the value into the ring. Returns false if the ring is full.
+    bool push(const T &val) {
+        T *slot = reserve();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = val;
+        commit();
+        return true;
+    }
+
+    // Moves the value into the ring. Returns false if the ring is full.
+    bool push(T &&val) {
+        T *slot = reserve();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = std::move(val);
+        commit();
+        return true;
+    }
+
+    //---------
+    // Consumer.
+
+    // Returns the oldest pushed value, or null if the ring is empty. The value
+    // stays in the ring until popped.
+    T *peek() {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cached_tail) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _cached_tail) {
+                return nullptr;
+            }
+        }
+        return &_buffer[head % _capacity];
+    }
+
+    // Pops the value returned by the last peek, making its slot available to
+    // the producer.
+    void pop() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    // Pops the oldest pushed value, moving it into val. Returns false if the
+    // ring is empty.
+    bool pop(T &val) {
+        T *slot = peek();
+        if (slot == nullptr) {
+            return false;
+        }
+        val = std::move(*slot);
+        pop();
+        return true;
+    }
+
+private:
+    // The indexes only grow, the slot is the index modulo the capacity. The
+    // consumer and producer indexes are kept on separate cache lines, together
+    // with the copy of the other side's index each side keeps to avoid loading
+    // it on every call. Padding is used rather than alignas, so that the
+    // alignment of the allocator does not matter.
+    static constexpr size_t cache_line_size = 64;
+
+    T *_buffer;
+    const size_t _capacity;
+    char _padding_0[cache_line_size];
+
+    // Consumer.
+    std::atomic<size_t> _head;  // The oldest pushed value that is not yet popped.
+    size_t _cached_tail;
+    char _padding_1[cache_line_size];
+
+    // Producer.
+    std::atomic<size_t> _tail;  // The slot of the next push.
+    size_t _cached_head;
+    char _padding_2[cache_line_size];
+};
+
+}  // namespace one
+}  // namespace i3d
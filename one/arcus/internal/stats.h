@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+namespace i3d {
+namespace one {
+
+// A statistics counter updated by one thread at a time and readable from any
+// thread. Updates are relaxed atomic loads and stores, so they cost about as
+// much as updating a plain integer.
+class StatCounter final {
+public:
+    StatCounter() : _value(0) {}
+
+    StatCounter(const StatCounter &) = delete;
+    StatCounter &operator=(const StatCounter &) = delete;
+
+    void add(uint64_t amount) {
+        _value.store(_value.load(std::memory_order_relaxed) + amount,
+                     std::memory_order_relaxed);
+    }
+
+    // For high-water marks.
+    void raise_to(uint64_t value) {
+        if (_value.load(std::memory_order_relaxed) < value) {
+            _value.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t get() const {
+        return _value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> _value;
+};
+
+// Adds the nanoseconds elapsed during its lifetime to the counter.
+class ScopedStatTimer final {
+public:
+    explicit ScopedStatTimer(StatCounter &counter)
+        : _counter(counter), _start(std::chrono::steady_clock::now()) {}
+    ~ScopedStatTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        _counter.add(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+private:
+    ScopedStatTimer(const ScopedStatTimer &) = delete;
+    ScopedStatTimer &operator=(const ScopedStatTimer &) = delete;
+
+    StatCounter &_counter;
+    const std::chrono::steady_clock::time_point _start;
+};
+
+}  // namespace one
+}  // namespace i3d
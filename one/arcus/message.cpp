@@ -1,26 +1,57 @@
 #include <one/arcus/message.h>
 
 #include <one/arcus/array.h>
+#include <one/arcus/internal/binary.h>
 #include <one/arcus/internal/rapidjson/stringbuffer.h>
 #include <one/arcus/internal/rapidjson/writer.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/object.h>
 
+#include <utility>
+
 namespace i3d {
 namespace one {
 
-Payload::Payload() : _doc(rapidjson::kObjectType) {}
+Payload::Payload()
+    : _doc(rapidjson::kObjectType, &_arena, arena_document_stack_capacity, &_arena) {}
 
-Payload::Payload(const Payload &other) {
+Payload::Payload(const Payload &other)
+    : _doc(rapidjson::kObjectType, &_arena, arena_document_stack_capacity, &_arena) {
     _doc.CopyFrom(other._doc, _doc.GetAllocator());
 }
 
+Payload::Payload(Payload &&other)
+    : _doc(rapidjson::kObjectType, &_arena, arena_document_stack_capacity, &_arena) {
+    *this = std::move(other);
+}
+
 Payload &Payload::operator=(const Payload &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    clear();
     _doc.CopyFrom(other._doc, _doc.GetAllocator());
     return *this;
 }
 
+Payload &Payload::operator=(Payload &&other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // Exchange the memory and the values, each document keeps allocating
+    // from the arena it owns.
+    _arena.swap(other._arena);
+    static_cast<rapidjson::Value &>(_doc).Swap(other._doc);
+    other.clear();
+    return *this;
+}
+
 OneError Payload::from_json(std::pair<const char *, size_t> data) {
+    // Parse into the memory of the previous document, so that parsing into a
+    // reused payload does not allocate.
+    clear();
     rapidjson::ParseResult ok = _doc.Parse(data.first, data.second);
     if (!ok) {
         return ONE_ERROR_PAYLOAD_PARSE_FAILED;
@@ -29,6 +60,16 @@ OneError Payload::from_json(std::pair<const char *, size_t> data) {
     return ONE_ERROR_NONE;
 }
 
+OneError Payload::from_binary(std::pair<const char *, size_t> data) {
+    clear();
+    if (!binary::read(data.first, data.second, _doc) || !_doc.IsObject()) {
+        clear();
+        return ONE_ERROR_PAYLOAD_PARSE_FAILED;
+    }
+
+    return ONE_ERROR_NONE;
+}
+
 String Payload::to_json() const {
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -42,6 +83,7 @@ bool Payload::is_empty() const {
 
 void Payload::clear() {
     _doc.SetObject();
+    _arena.reset();
 }
 
 bool Payload::is_val_bool(const char *key) const {
@@ -341,12 +383,27 @@ Message::Message(const Message &other) {
     _payload = other.payload();
 }
 
+Message::Message(Message &&other) : _code(other._code), _payload(std::move(other._payload)) {
+    other._code = Opcode::invalid;
+}
+
 Message &Message::operator=(const Message &other) {
     _code = other.code();
     _payload = other.payload();
     return *this;
 }
 
+Message &Message::operator=(Message &&other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    _code = other._code;
+    _payload = std::move(other._payload);
+    other._code = Opcode::invalid;
+    return *this;
+}
+
 OneError Message::init(Opcode code, std::pair<const char *, size_t> data) {
     _code = code;
     auto err = _payload.from_json(data);
@@ -358,12 +415,29 @@ OneError Message::init(Opcode code, std::pair<const char *, size_t> data) {
     return ONE_ERROR_NONE;
 }
 
+OneError Message::init_binary(Opcode code, std::pair<const char *, size_t> data) {
+    _code = code;
+    auto err = _payload.from_binary(data);
+    if (is_error(err)) {
+        _code = Opcode::invalid;
+        return err;
+    }
+
+    return ONE_ERROR_NONE;
+}
+
 OneError Message::init(Opcode code, const Payload &payload) {
     _code = code;
     _payload = payload;
     return ONE_ERROR_NONE;
 }
 
+OneError Message::init(Opcode code, Payload &&payload) {
+    _code = code;
+    _payload = std::move(payload);
+    return ONE_ERROR_NONE;
+}
+
 void Message::reset() {
     _code = Opcode::invalid;
     _payload.clear();
@@ -391,7 +465,7 @@ OneError prepare_soft_stop(int timeout, Message &message) {
     }
 
     message.reset();
-    err = message.init(Opcode::soft_stop, payload);
+    err = message.init(Opcode::soft_stop, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -407,7 +481,7 @@ OneError prepare_allocated(const Array &array, Message &message) {
     }
 
     message.reset();
-    err = message.init(Opcode::allocated, payload);
+    err = message.init(Opcode::allocated, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -423,7 +497,7 @@ OneError prepare_metadata(const Array &array, Message &message) {
     }
 
     message.reset();
-    err = message.init(Opcode::metadata, payload);
+    err = message.init(Opcode::metadata, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -439,7 +513,7 @@ OneError prepare_reverse_metadata(const Array &array, Message &message) {
     }
 
     message.reset();
-    err = message.init(Opcode::reverse_metadata, payload);
+    err = message.init(Opcode::reverse_metadata, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -494,7 +568,7 @@ prepare_live_state(int players, int max_players, const char *name, const char *m
     }
 
     message.reset();
-    err = message.init(Opcode::live_state, payload);
+    err = message.init(Opcode::live_state, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -509,7 +583,7 @@ OneError prepare_host_information(const Object &information, Message &message) {
         return err;
     }
 
-    err = message.init(Opcode::host_information, payload);
+    err = message.init(Opcode::host_information, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -525,7 +599,7 @@ OneError prepare_application_instance_information(const Object &information,
         return err;
     }
 
-    err = message.init(Opcode::application_instance_information, payload);
+    err = message.init(Opcode::application_instance_information, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -540,7 +614,7 @@ OneError prepare_application_instance_status(int status, Message &message) {
         return err;
     }
 
-    err = message.init(Opcode::application_instance_status, payload);
+    err = message.init(Opcode::application_instance_status, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -556,7 +630,7 @@ OneError prepare_custom_command(const Array &array, Message &message) {
     }
 
     message.reset();
-    err = message.init(Opcode::custom_command, payload);
+    err = message.init(Opcode::custom_command, std::move(payload));
     if (is_error(err)) {
         return err;
     }
@@ -5,6 +5,7 @@
 
 #include <one/arcus/error.h>
 #include <one/arcus/c_platform.h>
+#include <one/arcus/internal/arena.h>
 #include <one/arcus/internal/rapidjson/document.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/types.h>
@@ -22,11 +23,16 @@ class Payload final {
 public:
     Payload();
     Payload(const Payload &other);
+    Payload(Payload &&other);
     Payload &operator=(const Payload &other);
+    // Takes over the document of the other payload, which is left empty.
+    Payload &operator=(Payload &&other);
     ~Payload() = default;
 
     OneError from_json(std::pair<const char *, size_t> data);
     String to_json() const;
+    // Same as from_json, for data in the binary encoding, see binary::write.
+    OneError from_binary(std::pair<const char *, size_t> data);
 
     const rapidjson::Value &get() const {
         return _doc;
@@ -58,6 +64,7 @@ public:
     OneError set_val_root_object(const Object &val);
 
 private:
+    Arena _arena;  // Memory of _doc.
     rapidjson::Document _doc;
 };
 
@@ -65,11 +72,17 @@ class Message final {
 public:
     Message();
     Message(const Message &other);
+    Message(Message &&other);
     Message &operator=(const Message &other);
+    // Takes over the content of the other message, which is left reset.
+    Message &operator=(Message &&other);
     ~Message() = default;
 
     OneError init(Opcode code, std::pair<const char *, size_t> data);
+    // Same as above, for payload data in the binary encoding.
+    OneError init_binary(Opcode code, std::pair<const char *, size_t> data);
     OneError init(Opcode code, const Payload &payload);
+    OneError init(Opcode code, Payload &&payload);
 
     void reset();
 
@@ -7,38 +7,121 @@
 #include <one/arcus/opcode.h>
 
 #include <cstring>
+#include <utility>
 
 namespace i3d {
 namespace one {
 
-Object::Object() : _doc(rapidjson::kObjectType) {}
+namespace {
 
-Object::Object(const Object &other) {
+// FNV-1a.
+constexpr uint64_t hash_offset = 14695981039346656037ull;
+constexpr uint64_t hash_prime = 1099511628211ull;
+
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t size) {
+    auto bytes = reinterpret_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * hash_prime;
+    }
+    return hash;
+}
+
+template <typename T>
+uint64_t hash_value(uint64_t hash, const T &value) {
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+// The type is hashed along with the content and containers are hashed with
+// their size, so that e.g. "1" and 1 or [[]] and [] differ.
+uint64_t hash_json(uint64_t hash, const rapidjson::Value &value) {
+    hash = hash_value(hash, static_cast<int>(value.GetType()));
+    switch (value.GetType()) {
+        case rapidjson::kStringType:
+            hash = hash_value(hash, value.GetStringLength());
+            return hash_bytes(hash, value.GetString(), value.GetStringLength());
+        case rapidjson::kNumberType:
+            if (value.IsInt64()) return hash_value(hash, value.GetInt64());
+            if (value.IsUint64()) return hash_value(hash, value.GetUint64());
+            return hash_value(hash, value.GetDouble());
+        case rapidjson::kArrayType:
+            hash = hash_value(hash, value.Size());
+            for (const auto &element : value.GetArray()) {
+                hash = hash_json(hash, element);
+            }
+            return hash;
+        case rapidjson::kObjectType:
+            hash = hash_value(hash, value.MemberCount());
+            for (const auto &member : value.GetObject()) {
+                hash = hash_json(hash, member.name);
+                hash = hash_json(hash, member.value);
+            }
+            return hash;
+        default:  // Null, true and false are fully described by their type.
+            return hash;
+    }
+}
+
+}  // namespace
+
+Object::Object()
+    : _doc(rapidjson::kObjectType, &_arena, arena_document_stack_capacity, &_arena) {}
+
+Object::Object(const Object &other)
+    : _doc(rapidjson::kObjectType, &_arena, arena_document_stack_capacity, &_arena) {
     _doc.CopyFrom(other.get(), _doc.GetAllocator());
 }
 
+Object::Object(Object &&other)
+    : _doc(rapidjson::kObjectType, &_arena, arena_document_stack_capacity, &_arena) {
+    *this = std::move(other);
+}
+
 Object &Object::operator=(const Object &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    clear();
     _doc.CopyFrom(other.get(), _doc.GetAllocator());
     return *this;
 }
 
+Object &Object::operator=(Object &&other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    // Exchange the memory and the values, each document keeps allocating
+    // from the arena it owns.
+    _arena.swap(other._arena);
+    static_cast<rapidjson::Value &>(_doc).Swap(other._doc);
+    other.clear();
+    return *this;
+}
+
 OneError Object::set(const rapidjson::Value &object) {
     if (!object.IsObject()) {
         return ONE_ERROR_OBJECT_WRONG_TYPE_IS_EXPECTING_OBJECT;
     }
 
+    clear();
     _doc.CopyFrom(object, _doc.GetAllocator());
     return ONE_ERROR_NONE;
 }
 
 void Object::clear() {
     _doc.SetObject();
+    _arena.reset();
 }
 
 bool Object::is_empty() const {
     return _doc.ObjectEmpty();
 }
 
+uint64_t Object::hash() const {
+    return hash_json(hash_offset, _doc);
+}
+
 OneError Object::remove_key(const char *key) {
     if (key == nullptr) {
         return ONE_ERROR_OBJECT_KEY_IS_NULLPTR;
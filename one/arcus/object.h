@@ -1,9 +1,11 @@
 #pragma once
 
+#include <stdint.h>
 #include <functional>
 #include <utility>
 
 #include <one/arcus/error.h>
+#include <one/arcus/internal/arena.h>
 #include <one/arcus/internal/rapidjson/document.h>
 #include <one/arcus/types.h>
 
@@ -19,7 +21,10 @@ class Object final {
 public:
     Object();
     Object(const Object &other);
+    Object(Object &&other);
     Object &operator=(const Object &other);
+    // Takes over the document of the other object, which is left empty.
+    Object &operator=(Object &&other);
     ~Object() = default;
 
     OneError set(const rapidjson::Value &object);
@@ -32,6 +37,10 @@ public:
     bool is_empty() const;
     OneError remove_key(const char *key);
 
+    // Hash of the content, for cheap change detection. Equal objects have
+    // equal hashes, key order included.
+    uint64_t hash() const;
+
     // Type checks.
     bool is_val_bool(const char *key) const;
     bool is_val_int(const char *key) const;
@@ -55,6 +64,7 @@ public:
     OneError set_val_object(const char *key, const Object &val);
 
 private:
+    Arena _arena;  // Memory of _doc.
     rapidjson::Document _doc;
 };
 
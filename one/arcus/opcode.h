@@ -20,6 +20,11 @@ enum class Opcode {
     custom_command = 0x45
 };
 
+// Opcodes consumed by the connection itself. Their payload is never read.
+constexpr bool is_opcode_internal(Opcode code) {
+    return code == Opcode::health || code == Opcode::hello;
+}
+
 // To finalize when the list of supported opcode is confirmed.
 constexpr bool is_opcode_supported_v2(Opcode code) {
     return code == Opcode::health || code == Opcode::hello || code == Opcode::soft_stop ||
@@ -2,12 +2,17 @@
 
 #include <one/arcus/allocator.h>
 #include <one/arcus/internal/connection.h>
+#include <one/arcus/internal/dispatch.h>
 #include <one/arcus/internal/messages.h>
 #include <one/arcus/internal/mutex.h>
+#include <one/arcus/internal/poller.h>
 #include <one/arcus/internal/socket.h>
+#include <one/arcus/internal/spsc_ring.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/message.h>
 
+#include <utility>
+
 #define ONE_ARCUS_SERVER_LOGGING
 
 namespace i3d {
@@ -15,6 +20,16 @@ namespace one {
 
 namespace {
 size_t listen_retry_delay_seconds = 60;
+
+// How often the background thread of Threading::io_thread updates.
+constexpr std::chrono::milliseconds io_thread_interval(2);
+
+// Capacity of the queues between the threads. Same as the connection queues.
+constexpr size_t handoff_queue_capacity = Connection::max_message_default;
+
+// The messages a server sends, validated before queuing them.
+using OutgoingOpcodes = OpcodeList<Opcode::live_state, Opcode::reverse_metadata,
+                                   Opcode::application_instance_status>;
 }
 
 namespace server {
@@ -24,28 +39,92 @@ void set_listen_retry_delay(size_t seconds) {
 }
 }  // namespace server
 
-bool Server::game_states_changed(Server::GameState &new_state,
-                                 Server::GameState &old_state) {
-    if (new_state.players != old_state.players) {
-        return true;
-    }
-    if (new_state.max_players != old_state.max_players) {
-        return true;
-    }
-    if (new_state.name != old_state.name) {
-        return true;
-    }
-    if (new_state.map != old_state.map) {
-        return true;
-    }
-    if (new_state.mode != old_state.mode) {
-        return true;
+struct Server::GameState {
+    GameState()
+        : players(0)
+        , max_players(0)
+        , name()
+        , map()
+        , mode()
+        , version()
+        , additional_data()
+        , has_additional_data(false)
+        , additional_data_hash(0) {}
+
+    int players;      // Game number of players.
+    int max_players;  // Game max number of players.
+    String name;      // Server name.
+    String map;       // Game map.
+    String mode;      // Game mode.
+    String version;   // Game version.
+
+    Object additional_data;  // Optional extra fields.
+    bool has_additional_data;
+    uint64_t additional_data_hash;  // To compare additional_data cheaply.
+
+    // The GameStateField flags of the fields that differ from other.
+    unsigned int differences(const GameState &other) const {
+        unsigned int fields = 0;
+        if (players != other.players) fields |= players_field;
+        if (max_players != other.max_players) fields |= max_players_field;
+        if (name != other.name) fields |= name_field;
+        if (map != other.map) fields |= map_field;
+        if (mode != other.mode) fields |= mode_field;
+        if (version != other.version) fields |= version_field;
+        if (has_additional_data != other.has_additional_data ||
+            additional_data_hash != other.additional_data_hash) {
+            fields |= additional_data_field;
+        }
+        return fields;
     }
-    if (new_state.version != old_state.version) {
-        return true;
+
+    // Copies the given GameStateField fields from other.
+    void copy(const GameState &other, unsigned int fields) {
+        if (fields & players_field) players = other.players;
+        if (fields & max_players_field) max_players = other.max_players;
+        if (fields & name_field) name = other.name;
+        if (fields & map_field) map = other.map;
+        if (fields & mode_field) mode = other.mode;
+        if (fields & version_field) version = other.version;
+        if (fields & additional_data_field) {
+            additional_data = other.additional_data;
+            has_additional_data = other.has_additional_data;
+            additional_data_hash = other.additional_data_hash;
+        }
     }
-    return false;
-}
+};
+
+struct Server::PropertyChange {
+    PropertyChange()
+        : type(PropertyType::live_state)
+        , is_additional_data_unchanged(false)
+        , status(ApplicationInstanceStatus::starting) {}
+
+    PropertyType type;
+
+    // PropertyType::live_state.
+    GameState game_state;
+    // The additional data is the same as in the previous live state and was
+    // not copied into game_state.
+    bool is_additional_data_unchanged;
+
+    // PropertyType::application_instance_status.
+    ApplicationInstanceStatus status;
+
+    // PropertyType::reverse_metadata.
+    Message message;
+};
+
+// Later changes of a type are merged into its overflow until update_io applies
+// it, so that the changes are applied in order. Messages are not merged.
+struct Server::PropertyOverflow {
+    PropertyOverflow() : live_state(), has_live_state(false), status(), has_status(false) {}
+
+    PropertyChange live_state;
+    bool has_live_state;
+    PropertyChange status;
+    bool has_status;
+};
 
 // See: https://en.cppreference.com/w/cpp/language/value_initialization
 // C++11 Value initialization
@@ -55,34 +134,72 @@ Server::Server()
     , _listen_socket(nullptr)
     , _client_socket(nullptr)
     , _client_connection(nullptr)
+    , _poller(nullptr)
     , _is_waiting_for_client(false)
-    , _game_state()
-    , _last_sent_game_state()
-    , _game_state_was_set(false)
+    , _game_state(allocator::create<GameState>())
+    , _is_game_state_set(false)
+    , _last_sent_game_state(allocator::create<GameState>())
+    , _is_game_state_sent(false)
+    , _dirty_game_state_fields(0)
+    , _live_state_window(0)
+    , _live_state_max_delay(0)
+    , _live_state_first_change()
+    , _live_state_last_change()
+    , _is_binary_payloads_enabled(false)
     , _status(ApplicationInstanceStatus::starting)
     , _should_send_status(false)
-    , _callbacks{}
+    , _property_changes(
+          allocator::create<SpscRing<PropertyChange>>(handoff_queue_capacity))
+    , _property_overflow(allocator::create<PropertyOverflow>())
+    , _has_property_overflow(false)
+    , _has_queued_additional_data(false)
+    , _queued_additional_data_hash(0)
+    , _is_client_ready(false)
+    , _dispatch()
     , _last_listen_attempt_time(std::chrono::steady_clock::duration::zero())
-    , _additional_data(nullptr) {}
+    , _threading(Threading::game_thread)
+    , _should_stop_io_thread(false)
+    , _incoming_handoff(nullptr)
+    , _dispatched_message(nullptr)
+    , _io_thread_error(ONE_ERROR_NONE)
+    , _should_close_client(false)
+    , _has_stats(false) {}
 
 Server::~Server() {
     shutdown();
+
+    // Kept by shutdown, for the setters.
+    allocator::destroy<GameState>(_game_state);
+    allocator::destroy<GameState>(_last_sent_game_state);
+    allocator::destroy<SpscRing<PropertyChange>>(_property_changes);
+    allocator::destroy<PropertyOverflow>(_property_overflow);
 }
 
 void Server::set_logger(const Logger &logger) {
+    // The logger is used under either lock, by update's dispatch and by the
+    // I/O thread.
+    const std::lock_guard<std::recursive_mutex> dispatcher_lock(_dispatcher);
+    const std::lock_guard<std::mutex> lock(_server);
     _logger = logger;
 }
 
-OneError Server::init(unsigned int listen_port) {
+OneError Server::init(unsigned int listen_port, Threading threading) {
+    const std::lock_guard<std::recursive_mutex> dispatcher_lock(_dispatcher);
     const std::lock_guard<std::mutex> lock(_server);
 
     _listen_port = listen_port;
+    _threading = threading;
 
     if (_listen_socket != nullptr || _client_socket != nullptr ||
         _client_connection != nullptr) {
         return ONE_ERROR_SERVER_ALREADY_INITIALIZED;
     }
 
+    if (_game_state == nullptr || _last_sent_game_state == nullptr ||
+        _property_changes == nullptr || _property_overflow == nullptr) {
+        return ONE_ERROR_SERVER_ALLOCATION_FAILED;
+    }
+
     auto err = init_socket_system();
     if (is_error(err)) {
         return err;
@@ -93,6 +210,13 @@ OneError Server::init(unsigned int listen_port) {
         return ONE_ERROR_SERVER_SOCKET_ALLOCATION_FAILED;
     }
 
+    // Poll the sockets if supported, otherwise they are checked with select.
+    _poller = allocator::create<Poller>();
+    if (_poller != nullptr && is_error(_poller->init())) {
+        allocator::destroy<Poller>(_poller);
+        _poller = nullptr;
+    }
+
     err = _listen_socket->init();
     if (is_error(err)) {
         shutdown();
@@ -105,19 +229,31 @@ OneError Server::init(unsigned int listen_port) {
         return ONE_ERROR_SERVER_SOCKET_ALLOCATION_FAILED;
     }
 
-    _additional_data = allocator::create<Object>();
-    if (_additional_data == nullptr) {
-        shutdown();
-        return ONE_ERROR_SERVER_OBJECT_ALLOCATION_FAILED;
+    // The live state is kept from before init, or a previous one, and sent
+    // once a client connects.
+    _dirty_game_state_fields = 0;
+
+    if (_threading == Threading::io_thread) {
+        _incoming_handoff = allocator::create<SpscRing<Message>>(handoff_queue_capacity);
+        _dispatched_message = allocator::create<Message>();
+        if (_incoming_handoff == nullptr || _dispatched_message == nullptr) {
+            shutdown();
+            return ONE_ERROR_SERVER_ALLOCATION_FAILED;
+        }
     }
 
     const auto max_incoming = Connection::max_message_default;
     const auto max_outgoing = Connection::max_message_default;
-    _client_connection = allocator::create<Connection>(max_incoming, max_outgoing);
+    {
+        allocator::ScopedSubsystem subsystem(allocator::Subsystem::connection);
+        _client_connection = allocator::create<Connection>(max_incoming, max_outgoing);
+    }
     if (_client_connection == nullptr) {
         shutdown();
         return ONE_ERROR_SERVER_CONNECTION_IS_NULLPTR;
     }
+    _client_connection->set_stats(_connection_stats);
+    _has_stats = true;
 
     // Attempt to start listening at init time, but if port binding fails then
     // update will try to listen again periodically, so punt the bind error
@@ -127,14 +263,24 @@ OneError Server::init(unsigned int listen_port) {
         return err;
     }
 
+    if (_threading == Threading::io_thread) {
+        start_io_thread();
+    }
+
     return ONE_ERROR_NONE;
 }
 
 OneError Server::shutdown() {
-    _logger.Log(LogLevel::Info, "server is shutting down");
+    // Before locking, the thread needs the lock to finish its update.
+    stop_io_thread();
 
+    // Waits for an update dispatching on another thread.
+    const std::lock_guard<std::recursive_mutex> dispatcher_lock(_dispatcher);
     const std::lock_guard<std::mutex> lock(_server);
 
+    _logger.Log(LogLevel::Info, "server is shutting down");
+
+    _has_stats = false;
     if (_client_connection != nullptr) {
         allocator::destroy<Connection>(_client_connection);
         _client_connection = nullptr;
@@ -150,14 +296,26 @@ OneError Server::shutdown() {
         _client_socket = nullptr;
     }
 
-    if (_additional_data != nullptr) {
-        allocator::destroy<Object>(_additional_data);
-        _additional_data = nullptr;
+    // After the sockets, which remove themselves from it when closed.
+    if (_poller != nullptr) {
+        allocator::destroy<Poller>(_poller);
+        _poller = nullptr;
+    }
+
+    // The live state, status and queued changes are kept for a later init.
+    _is_client_ready = false;
+
+    if (_incoming_handoff != nullptr) {
+        allocator::destroy<SpscRing<Message>>(_incoming_handoff);
+        _incoming_handoff = nullptr;
+    }
+    if (_dispatched_message != nullptr) {
+        allocator::destroy<Message>(_dispatched_message);
+        _dispatched_message = nullptr;
     }
 
     shutdown_socket_system();
-    ServerCallbacks cb{};
-    _callbacks = cb;
+    _dispatch.clear();
     return ONE_ERROR_NONE;
 }
 
@@ -204,6 +362,28 @@ Server::Status Server::status() const {
     }
 }
 
+OneError Server::stats(Stats &stats) const {
+    // The counters are owned by the server, and read lock-free.
+    if (!_has_stats) {
+        return ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED;
+    }
+
+    const auto &connection = _connection_stats;
+    stats.messages_in = connection.messages_in.get();
+    stats.messages_out = connection.messages_out.get();
+    stats.bytes_in = connection.bytes_in.get();
+    stats.bytes_out = connection.bytes_out.get();
+    stats.update_time = _update_time.get();
+    stats.io_time = _io_time.get();
+    stats.connection_time = connection.update_time.get();
+    stats.encode_time = connection.encode_time.get();
+    stats.decode_time = connection.decode_time.get();
+    stats.dispatch_time = _dispatch_time.get();
+    stats.incoming_queue_peak = connection.incoming_queue_peak.get();
+    stats.outgoing_queue_peak = connection.outgoing_queue_peak.get();
+    return ONE_ERROR_NONE;
+}
+
 OneError Server::listen() {
     if (_listen_socket == nullptr) {
         return ONE_ERROR_SERVER_SOCKET_IS_NULLPTR;
@@ -246,6 +426,11 @@ OneError Server::listen() {
         return err;
     }
 
+    // Falls back to select if the socket can't be polled.
+    if (_poller != nullptr) {
+        _poller->add(*_listen_socket);
+    }
+
     _is_listening = true;
     _is_waiting_for_client = true;
 
@@ -298,6 +483,10 @@ OneError Server::update_listen_socket() {
     _is_waiting_for_client = false;
 
     *_client_socket = incoming_client;
+    if (_poller != nullptr) {
+        _poller->add(*_client_socket);
+    }
+    _client_connection->set_binary_payloads_supported(_is_binary_payloads_enabled);
     _client_connection->init(*_client_socket);
 
     // The Arcus Server is responsible for initiating the handshake against agents.
@@ -308,11 +497,6 @@ OneError Server::update_listen_socket() {
 }
 
 OneError Server::process_incoming_message(const Message &message) {
-    // Unlock and relock the server mutex when processing incoming messages to
-    // allow the callback to be re-entrant on server functions (e.g. to send
-    // an outgoing message in response to an incoming message).
-    const ReverseLockGuard<std::mutex> reverse_lock(_server);
-
 #ifdef ONE_ARCUS_SERVER_LOGGING
     OStringStream stream;
     stream << "incoming opcode: " << static_cast<int>(message.code())
@@ -320,56 +504,10 @@ OneError Server::process_incoming_message(const Message &message) {
     _logger.Log(LogLevel::Info, stream.str());
 #endif
 
-    switch (message.code()) {
-        case Opcode::soft_stop:
-            if (_callbacks._soft_stop == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::soft_stop(message, _callbacks._soft_stop,
-                                         _callbacks._soft_stop_userdata);
-        case Opcode::allocated:
-            if (_callbacks._allocated == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::allocated(message, _callbacks._allocated,
-                                         _callbacks._allocated_userdata);
-        case Opcode::metadata:
-            if (_callbacks._metadata == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::metadata(message, _callbacks._metadata,
-                                        _callbacks._metadata_userdata);
-        case Opcode::host_information:
-            if (_callbacks._host_information == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::host_information(message, _callbacks._host_information,
-                                                _callbacks._host_information_data);
-        case Opcode::application_instance_information:
-            if (_callbacks._application_instance_information == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::application_instance_information(
-                message, _callbacks._application_instance_information,
-                _callbacks._application_instance_information_data);
-        case Opcode::custom_command:
-            if (_callbacks._custom_command == nullptr) {
-                return ONE_ERROR_NONE;
-            }
-
-            return invocation::custom_command(message, _callbacks._custom_command,
-                                              _callbacks._custom_command_userdata);
-        default:
-            return ONE_ERROR_NONE;
-    }
+    return _dispatch.dispatch(message);
 }
 
-OneError Server::process_outgoing_message(const Message &message) {
+OneError Server::process_outgoing_message(Message &&message) {
 #ifdef ONE_ARCUS_SERVER_LOGGING
     OStringStream stream;
     stream << "outgoing opcode: " << static_cast<int>(message.code())
@@ -377,37 +515,13 @@ OneError Server::process_outgoing_message(const Message &message) {
     _logger.Log(LogLevel::Info, stream.str());
 #endif
 
-    OneError err = ONE_ERROR_NONE;
-    switch (message.code()) {
-        case Opcode::live_state: {
-            params::LiveStateResponse params;
-            err = validation::live_state(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::reverse_metadata: {
-            params::ReverseMetaDataResponse params;
-            err = validation::reverse_metadata(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        case Opcode::application_instance_status: {
-            params::ApplicationInstanceSetStatusRequest params;
-            err = validation::application_instance_status(message, params);
-            if (is_error(err)) {
-                return err;
-            }
-
-            break;
-        }
-        default:
-            return ONE_ERROR_NONE;
+    bool is_sent = false;
+    auto err = OutgoingOpcodes::validate(message, is_sent);
+    if (is_error(err)) {
+        return err;
+    }
+    if (!is_sent) {
+        return ONE_ERROR_NONE;
     }
 
     if (_client_connection == nullptr) {
@@ -419,7 +533,7 @@ OneError Server::process_outgoing_message(const Message &message) {
         return ONE_ERROR_SERVER_CONNECTION_NOT_READY;
     }
 
-    err = _client_connection->add_outgoing(message);
+    err = _client_connection->add_outgoing(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -431,6 +545,7 @@ void Server::close_client_connection() {
     _client_connection->shutdown();
     _client_socket->close();
     _is_waiting_for_client = true;
+    _is_client_ready = false;
 
 #ifdef ONE_ARCUS_SERVER_LOGGING
     String ip;
@@ -457,10 +572,25 @@ OneError Server::update_client_connection() {
         return fail(err);
     }
 
+    return ONE_ERROR_NONE;
+}
+
+OneError Server::dispatch_incoming_messages() {
+    // Done if no client is connected.
+    if (!_client_socket->is_initialized() ||
+        _client_connection->status() == Connection::Status::uninitialized) {
+        return ONE_ERROR_NONE;
+    }
+
+    auto fail = [this](const OneError passthrough_err) -> OneError {
+        close_client_connection();
+        return passthrough_err;
+    };
+
     // Read pending incoming messages.
     while (true) {
         unsigned int count = 0;
-        err = _client_connection->incoming_count(count);
+        auto err = _client_connection->incoming_count(count);
         if (is_error(err)) return fail(err);
 
         if (count == 0) break;
@@ -471,8 +601,15 @@ OneError Server::update_client_connection() {
         _logger.Log(LogLevel::Info, stream.str());
 #endif
 
-        err = _client_connection->remove_incoming(
-            [this](const Message &message) { return process_incoming_message(message); });
+        err = _client_connection->remove_incoming([this](const Message &message) {
+            // Unlock and relock the server mutex when processing incoming
+            // messages to allow the callback to be re-entrant on server
+            // functions (e.g. to send an outgoing message in response to an
+            // incoming message).
+            const ReverseLockGuard<std::mutex> reverse_lock(_server);
+            ScopedStatTimer timer(_dispatch_time);
+            return process_incoming_message(message);
+        });
         if (is_error(err)) return fail(err);
     }
 
@@ -480,15 +617,58 @@ OneError Server::update_client_connection() {
 }
 
 OneError Server::update() {
+    const std::lock_guard<std::recursive_mutex> dispatcher_lock(_dispatcher);
+    // Without the time waiting for another update or shutdown.
+    ScopedStatTimer timer(_update_time);
+    if (_threading == Threading::io_thread) {
+        // Without the server lock, never waits for the background thread, e.g.
+        // while it decodes a large message.
+        if (_incoming_handoff == nullptr) {
+            return ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED;
+        }
+
+        const auto err = _io_thread_error.exchange(ONE_ERROR_NONE);
+        if (is_error(err)) {
+            return err;
+        }
+
+        return dispatch_handed_off_messages();
+    }
+
     const std::lock_guard<std::mutex> lock(_server);
 
     if (!is_initialized()) {
         return ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED;
     }
 
+    auto err = update_io();
+    if (is_error(err)) {
+        return err;
+    }
+
+    return dispatch_incoming_messages();
+}
+
+OneError Server::update_io() {
+    ScopedStatTimer timer(_io_time);
     assert(_client_socket != nullptr);
     assert(_client_connection != nullptr);
 
+    if (_should_close_client.exchange(false) && _client_socket->is_initialized()) {
+        close_client_connection();
+    }
+
+    apply_property_changes();
+
+    // Collect the readiness of both sockets at once. Sockets that did not
+    // become ready are skipped below without further system calls.
+    if (_poller != nullptr) {
+        auto err = _poller->update();
+        if (is_error(err)) {
+            return err;
+        }
+    }
+
     auto err = update_listen_socket();
     if (is_error(err)) {
         return err;
@@ -501,20 +681,21 @@ OneError Server::update() {
 
     const bool was_ready = (_client_connection->status() == Connection::Status::ready);
 
-    if (was_ready && _game_state_was_set) {
-        if (game_states_changed(_game_state, _last_sent_game_state)) {
-            if (_client_connection->status() == Connection::Status::ready) {
-                err = send_live_state();
-                if (is_error(err)) {
-                    close_client_connection();
-                    return err;
-                }
-                _game_state_was_set = false;
-                _last_sent_game_state = _game_state;
+    if (was_ready && _dirty_game_state_fields != 0 && is_live_state_due()) {
+        // Fields changed back to the sent values since are not sent again.
+        if (_is_game_state_sent) {
+            _dirty_game_state_fields = _game_state->differences(*_last_sent_game_state);
+        }
+        if (_dirty_game_state_fields != 0) {
+            err = send_live_state();
+            if (is_error(err)) {
+                close_client_connection();
+                return err;
             }
-        } else {
-            _game_state_was_set = false;
+            _last_sent_game_state->copy(*_game_state, _dirty_game_state_fields);
+            _is_game_state_sent = true;
         }
+        _dirty_game_state_fields = 0;
     }
     if (was_ready && _should_send_status) {
         err = send_application_instance_status();
@@ -531,75 +712,366 @@ OneError Server::update() {
     }
 
     const bool is_ready = (_client_connection->status() == Connection::Status::ready);
+    _is_client_ready = is_ready;
     if (is_ready && !was_ready) {
         // Schedule a send when connection is established to ensure newly
         // connected client has the correct state.
-        _game_state_was_set = true;
+        _is_game_state_sent = false;
+        if (_is_game_state_set) {
+            _dirty_game_state_fields = all_fields;
+            // Without delay.
+            _live_state_first_change = std::chrono::steady_clock::time_point();
+            _live_state_last_change = _live_state_first_change;
+        }
         _should_send_status = true;
     }
 
     return ONE_ERROR_NONE;
 }
 
-OneError Server::set_live_state(int players, int max_players, const char *name,
-                                const char *map, const char *mode, const char *version,
-                                Object *additional_data) {
-    const std::lock_guard<std::mutex> lock(_server);
+void Server::start_io_thread() {
+    assert(!_io_thread.joinable());
+    _should_stop_io_thread = false;
+    _io_thread_error = ONE_ERROR_NONE;
+    _io_thread = std::thread(&Server::run_io_thread, this);
+}
 
-    if (additional_data == nullptr) {
-        _additional_data = nullptr;
-    } else {
-        (*_additional_data) = *additional_data;
+void Server::stop_io_thread() {
+    if (!_io_thread.joinable()) {
+        return;
     }
 
-    _game_state.players = players;
-    _game_state.max_players = max_players;
-    _game_state.name = name;
-    _game_state.map = map;
-    _game_state.mode = mode;
-    _game_state.version = version;
-    _game_state.additional_data = _additional_data;
-    _game_state_was_set = true;
+    {
+        const std::lock_guard<std::mutex> lock(_io_thread_mutex);
+        _should_stop_io_thread = true;
+    }
+    _io_thread_wake.notify_one();
+    _io_thread.join();
+}
+
+void Server::run_io_thread() {
+    std::unique_lock<std::mutex> wait_lock(_io_thread_mutex);
+    while (!_should_stop_io_thread) {
+        wait_lock.unlock();
+        {
+            const std::lock_guard<std::mutex> lock(_server);
+            const auto err = update_io();
+            if (is_error(err)) {
+                _io_thread_error = err;
+            }
+            hand_off_incoming_messages();
+        }
+        wait_lock.lock();
+        _io_thread_wake.wait_for(wait_lock, io_thread_interval,
+                                 [this]() { return _should_stop_io_thread; });
+    }
+}
 
+void Server::hand_off_incoming_messages() {
+    if (!_client_socket->is_initialized() ||
+        _client_connection->status() == Connection::Status::uninitialized) {
+        return;
+    }
+
+    unsigned int count = 0;
+    while (!is_error(_client_connection->incoming_count(count)) && count > 0) {
+        // Messages that don't fit stay queued in the connection until update
+        // catches up.
+        Message *message = _incoming_handoff->reserve();
+        if (message == nullptr) {
+            return;
+        }
+        _client_connection->pop_incoming(*message);
+        _incoming_handoff->commit();
+    }
+}
+
+OneError Server::dispatch_handed_off_messages() {
+    Message &message = *_dispatched_message;
+    while (_incoming_handoff->pop(message)) {
+        OneError err;
+        {
+            ScopedStatTimer timer(_dispatch_time);
+            err = process_incoming_message(message);
+        }
+        message.reset();
+        if (is_error(err)) {
+            // As in game thread mode, a bad message closes the client. The
+            // thread owns the connection, so it does the closing.
+            _should_close_client = true;
+            return err;
+        }
+    }
     return ONE_ERROR_NONE;
 }
 
-OneError Server::set_application_instance_status(ApplicationInstanceStatus status) {
-    const std::lock_guard<std::mutex> lock(_server);
+template <typename Fill>
+OneError Server::queue_property_change(PropertyType type, Fill fill) {
+    const std::lock_guard<std::mutex> lock(_property_producer);
 
-    if (status == _status) return ONE_ERROR_NONE;
+    if (_property_changes == nullptr || _property_overflow == nullptr) {
+        return ONE_ERROR_SERVER_ALLOCATION_FAILED;
+    }
 
-    _status = status;
-    _should_send_status = true;
+    PropertyChange *overflow = nullptr;
+    bool *has_overflow = nullptr;
+    switch (type) {
+        case PropertyType::live_state:
+            overflow = &_property_overflow->live_state;
+            has_overflow = &_property_overflow->has_live_state;
+            break;
+        case PropertyType::application_instance_status:
+            overflow = &_property_overflow->status;
+            has_overflow = &_property_overflow->has_status;
+            break;
+        case PropertyType::reverse_metadata:
+            break;
+    }
+
+    if (overflow == nullptr || !*has_overflow) {
+        // Filling the slot in place reuses the memory of the change it held.
+        PropertyChange *change = _property_changes->reserve();
+        if (change != nullptr) {
+            auto err = fill(*change);
+            if (is_error(err)) {
+                return err;
+            }
+
+            _property_changes->commit();
+            return ONE_ERROR_NONE;
+        }
+
+        if (overflow == nullptr) {
+            return ONE_ERROR_SERVER_PROPERTY_QUEUE_FULL;
+        }
+    }
+
+    // The additional data copied into the overflow is kept if the latest
+    // change leaves it unchanged.
+    const bool has_additional_data =
+        *has_overflow && !overflow->is_additional_data_unchanged;
+    auto err = fill(*overflow);
+    if (is_error(err)) {
+        return err;
+    }
+    if (has_additional_data) {
+        overflow->is_additional_data_unchanged = false;
+    }
 
+    *has_overflow = true;
+    _has_property_overflow = true;
     return ONE_ERROR_NONE;
 }
 
-OneError Server::set_soft_stop_callback(std::function<void(void *, int)> callback,
-                                        void *data) {
+void Server::apply_property_changes() {
+    PropertyChange *change = nullptr;
+    while ((change = _property_changes->peek()) != nullptr) {
+        apply_property_change(*change);
+        _property_changes->pop();
+    }
+
+    if (!_has_property_overflow) {
+        return;
+    }
+
+    // While the setters wait, the queue holds no change newer than the
+    // overflow of its type.
+    const std::lock_guard<std::mutex> lock(_property_producer);
+    while ((change = _property_changes->peek()) != nullptr) {
+        apply_property_change(*change);
+        _property_changes->pop();
+    }
+    PropertyOverflow &overflow = *_property_overflow;
+    if (overflow.has_live_state) {
+        apply_property_change(overflow.live_state);
+        overflow.has_live_state = false;
+    }
+    if (overflow.has_status) {
+        apply_property_change(overflow.status);
+        overflow.has_status = false;
+    }
+    _has_property_overflow = false;
+}
+
+void Server::apply_property_change(PropertyChange &change) {
+    switch (change.type) {
+        case PropertyType::live_state:
+            apply_live_state(change);
+            break;
+        case PropertyType::application_instance_status:
+            if (change.status != _status) {
+                _status = change.status;
+                _should_send_status = true;
+            }
+            break;
+        case PropertyType::reverse_metadata: {
+            const auto err = process_outgoing_message(std::move(change.message));
+#ifdef ONE_ARCUS_SERVER_LOGGING
+            if (is_error(err)) {
+                // E.g. the client disconnected since it was queued.
+                OStringStream stream;
+                stream << "reverse metadata dropped: " << error_text(err);
+                _logger.Log(LogLevel::Error, stream.str());
+            }
+#else
+            (void)err;
+#endif
+            break;
+        }
+    }
+}
+
+void Server::apply_live_state(PropertyChange &change) {
+    GameState &state = *_game_state;
+    GameState &next = change.game_state;
+    unsigned int dirty = 0;
+
+    if (next.players != state.players) {
+        state.players = next.players;
+        dirty |= players_field;
+    }
+    if (next.max_players != state.max_players) {
+        state.max_players = next.max_players;
+        dirty |= max_players_field;
+    }
+    // Swap strings, so that the queue slot keeps the memory of the previous
+    // ones for reuse.
+    if (next.name != state.name) {
+        std::swap(state.name, next.name);
+        dirty |= name_field;
+    }
+    if (next.map != state.map) {
+        std::swap(state.map, next.map);
+        dirty |= map_field;
+    }
+    if (next.mode != state.mode) {
+        std::swap(state.mode, next.mode);
+        dirty |= mode_field;
+    }
+    if (next.version != state.version) {
+        std::swap(state.version, next.version);
+        dirty |= version_field;
+    }
+    if (!change.is_additional_data_unchanged &&
+        (next.has_additional_data != state.has_additional_data ||
+         next.additional_data_hash != state.additional_data_hash)) {
+        std::swap(state.additional_data, next.additional_data);
+        state.has_additional_data = next.has_additional_data;
+        state.additional_data_hash = next.additional_data_hash;
+        dirty |= additional_data_field;
+    }
+
+    // The first set is sent even if it matches the defaults.
+    if (!_is_game_state_set) {
+        _is_game_state_set = true;
+        dirty = all_fields;
+    }
+    if (dirty != 0) {
+        const auto now = std::chrono::steady_clock::now();
+        if (_dirty_game_state_fields == 0) {
+            _live_state_first_change = now;
+        }
+        _live_state_last_change = now;
+    }
+    _dirty_game_state_fields |= dirty;
+}
+
+OneError Server::set_live_state_coalescing(unsigned int window_ms,
+                                           unsigned int max_delay_ms) {
+    if (max_delay_ms < window_ms) {
+        return ONE_ERROR_SERVER_INVALID_LIVE_STATE_COALESCING;
+    }
+
+    const std::lock_guard<std::mutex> lock(_server);
+    _live_state_window = std::chrono::milliseconds(window_ms);
+    _live_state_max_delay = std::chrono::milliseconds(max_delay_ms);
+    return ONE_ERROR_NONE;
+}
+
+void Server::set_binary_payloads(bool is_enabled) {
     const std::lock_guard<std::mutex> lock(_server);
+    _is_binary_payloads_enabled = is_enabled;
+}
+
+bool Server::is_live_state_due() const {
+    if (_live_state_window.count() == 0) {
+        return true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    return (now - _live_state_last_change >= _live_state_window) ||
+           (now - _live_state_first_change >= _live_state_max_delay);
+}
+
+OneError Server::set_live_state(int players, int max_players, const char *name,
+                                const char *map, const char *mode, const char *version,
+                                Object *additional_data) {
+    const auto fill = [&](PropertyChange &change) -> OneError {
+        change.type = PropertyType::live_state;
+        GameState &state = change.game_state;
+        state.players = players;
+        state.max_players = max_players;
+        state.name = name;
+        state.map = map;
+        state.mode = mode;
+        state.version = version;
+
+        // Only copy the additional data if it differs from the last queued
+        // one. Hashing is much cheaper than copying it.
+        const bool has_additional_data = (additional_data != nullptr);
+        const uint64_t hash = has_additional_data ? additional_data->hash() : 0;
+        change.is_additional_data_unchanged =
+            (has_additional_data == _has_queued_additional_data &&
+             hash == _queued_additional_data_hash);
+        if (!change.is_additional_data_unchanged) {
+            state.has_additional_data = has_additional_data;
+            state.additional_data_hash = hash;
+            if (has_additional_data) {
+                state.additional_data = *additional_data;
+            } else {
+                state.additional_data.clear();
+            }
+            _has_queued_additional_data = has_additional_data;
+            _queued_additional_data_hash = hash;
+        }
+        return ONE_ERROR_NONE;
+    };
+    return queue_property_change(PropertyType::live_state, fill);
+}
+
+OneError Server::set_application_instance_status(ApplicationInstanceStatus status) {
+    const auto fill = [&](PropertyChange &change) -> OneError {
+        change.type = PropertyType::application_instance_status;
+        change.status = status;
+        return ONE_ERROR_NONE;
+    };
+    return queue_property_change(PropertyType::application_instance_status, fill);
+}
+
+OneError Server::set_soft_stop_callback(void (*callback)(void *, int), void *data) {
+    const std::lock_guard<std::recursive_mutex> lock(_dispatcher);
 
     if (callback == nullptr) {
         return ONE_ERROR_SERVER_CALLBACK_IS_NULLPTR;
     }
 
-    _callbacks._soft_stop = callback;
-    _callbacks._soft_stop_userdata = data;
+    _dispatch.set<Opcode::soft_stop>(callback, data);
     return ONE_ERROR_NONE;
 }
 
 OneError Server::send_live_state() {
     Message message;
+    GameState &state = *_game_state;
     auto err = messages::prepare_live_state(
-        _game_state.players, _game_state.max_players, _game_state.name.c_str(),
-        _game_state.map.c_str(), _game_state.mode.c_str(), _game_state.version.c_str(),
-        _game_state.additional_data, message);
+        state.players, state.max_players, state.name.c_str(), state.map.c_str(),
+        state.mode.c_str(), state.version.c_str(),
+        state.has_additional_data ? &state.additional_data : nullptr, message);
 
     if (is_error(err)) {
         return err;
     }
 
-    err = process_outgoing_message(message);
+    err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -612,19 +1084,17 @@ OneError Server::send_reverse_metadata(Array *data) {
         return ONE_ERROR_VALIDATION_DATA_IS_NULLPTR;
     }
 
-    Message message;
-    auto err = messages::prepare_reverse_metadata(*data, message);
-
-    if (is_error(err)) {
-        return err;
-    }
-
-    err = process_outgoing_message(message);
-    if (is_error(err)) {
-        return err;
+    // Checked here to report it to the caller, the message is still dropped
+    // if the client disconnects before it is sent.
+    if (!_is_client_ready) {
+        return ONE_ERROR_SERVER_CONNECTION_NOT_READY;
     }
 
-    return ONE_ERROR_NONE;
+    const auto fill = [&](PropertyChange &change) -> OneError {
+        change.type = PropertyType::reverse_metadata;
+        return messages::prepare_reverse_metadata(*data, change.message);
+    };
+    return queue_property_change(PropertyType::reverse_metadata, fill);
 }
 
 OneError Server::send_application_instance_status() {
@@ -634,7 +1104,7 @@ OneError Server::send_application_instance_status() {
         return err;
     }
 
-    err = process_outgoing_message(message);
+    err = process_outgoing_message(std::move(message));
     if (is_error(err)) {
         return err;
     }
@@ -642,66 +1112,61 @@ OneError Server::send_application_instance_status() {
     return ONE_ERROR_NONE;
 }
 
-OneError Server::set_allocated_callback(std::function<void(void *, Array *)> callback,
-                                        void *data) {
-    const std::lock_guard<std::mutex> lock(_server);
+OneError Server::set_allocated_callback(void (*callback)(void *, void *), void *data) {
+    const std::lock_guard<std::recursive_mutex> lock(_dispatcher);
 
     if (callback == nullptr) {
         return ONE_ERROR_SERVER_CALLBACK_IS_NULLPTR;
     }
 
-    _callbacks._allocated = callback;
-    _callbacks._allocated_userdata = data;
+    _dispatch.set<Opcode::allocated>(callback, data);
     return ONE_ERROR_NONE;
 }
 
-OneError Server::set_metadata_callback(std::function<void(void *, Array *)> callback,
-                                       void *data) {
-    const std::lock_guard<std::mutex> lock(_server);
+OneError Server::set_metadata_callback(void (*callback)(void *, void *), void *data) {
+    const std::lock_guard<std::recursive_mutex> lock(_dispatcher);
 
     if (callback == nullptr) {
         return ONE_ERROR_SERVER_CALLBACK_IS_NULLPTR;
     }
 
-    _callbacks._metadata = callback;
-    _callbacks._metadata_userdata = data;
+    _dispatch.set<Opcode::metadata>(callback, data);
     return ONE_ERROR_NONE;
 }
 
 OneError Server::set_host_information_callback(
-    std::function<void(void *, Object *)> callback, void *data) {
-    const std::lock_guard<std::mutex> lock(_server);
+    void (*callback)(void *, void *), void *data) {
+    const std::lock_guard<std::recursive_mutex> lock(_dispatcher);
 
     if (callback == nullptr) {
         return ONE_ERROR_SERVER_CALLBACK_IS_NULLPTR;
     }
 
-    _callbacks._host_information = callback;
-    _callbacks._host_information_data = data;
+    _dispatch.set<Opcode::host_information>(callback, data);
     return ONE_ERROR_NONE;
 }
 
 OneError Server::set_application_instance_information_callback(
-    std::function<void(void *, Object *)> callback, void *data) {
-    const std::lock_guard<std::mutex> lock(_server);
+    void (*callback)(void *, void *), void *data) {
+    const std::lock_guard<std::recursive_mutex> lock(_dispatcher);
 
     if (callback == nullptr) {
         return ONE_ERROR_SERVER_CALLBACK_IS_NULLPTR;
     }
 
-    _callbacks._application_instance_information = callback;
-    _callbacks._application_instance_information_data = data;
+    _dispatch.set<Opcode::application_instance_information>(callback, data);
     return ONE_ERROR_NONE;
 }
 
 OneError Server::set_custom_command_callback(
-    std::function<void(void *, Array *)> callback, void *data) {
+    void (*callback)(void *, void *), void *data) {
+    const std::lock_guard<std::recursive_mutex> lock(_dispatcher);
+
     if (callback == nullptr) {
         return ONE_ERROR_SERVER_CALLBACK_IS_NULLPTR;
     }
 
-    _callbacks._custom_command = callback;
-    _callbacks._custom_command_userdata = data;
+    _dispatch.set<Opcode::custom_command>(callback, data);
     return ONE_ERROR_NONE;
 }
 
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <stdint.h>
+#include <atomic>
 #include <chrono>
-#include <functional>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 #include <one/arcus/error.h>
+#include <one/arcus/internal/connection.h>
+#include <one/arcus/internal/dispatch.h>
+#include <one/arcus/internal/stats.h>
 #include <one/arcus/logger.h>
 #include <one/arcus/types.h>
 
@@ -17,25 +23,12 @@ void set_listen_retry_delay(size_t seconds);
 }  // namespace server
 
 class Array;
-class Connection;
 class Message;
 class Object;
+class Poller;
 class Socket;
-
-struct ServerCallbacks {
-    std::function<void(void *, int)> _soft_stop;
-    void *_soft_stop_userdata;
-    std::function<void(void *, Array *)> _allocated;
-    void *_allocated_userdata;
-    std::function<void(void *, Array *)> _metadata;
-    void *_metadata_userdata;
-    std::function<void(void *, Object *)> _host_information;
-    void *_host_information_data;
-    std::function<void(void *, Object *)> _application_instance_information;
-    void *_application_instance_information_data;
-    std::function<void(void *, Array *)> _custom_command;
-    void *_custom_command_userdata;
-};
+template <typename T>
+class SpscRing;
 
 // An Arcus Server is designed for use by a Game. It allows an Arcus One Agent
 // to connect and communicate with the game.
@@ -46,8 +39,19 @@ public:
     Server &operator=(const Server &) = delete;
     ~Server();
 
+    // Waits for update and the background thread, which call the logger.
     void set_logger(const Logger &);
-    OneError init(unsigned int listen_port);
+
+    // Where the socket I/O, message encoding and decoding of the server run.
+    enum class Threading {
+        // All in update, on the calling thread.
+        game_thread,
+        // On a background thread owned by the server. Update then only
+        // dispatches the already decoded incoming messages to the callbacks.
+        // The logger is also called from the background thread.
+        io_thread
+    };
+    OneError init(unsigned int listen_port, Threading threading = Threading::game_thread);
 
     OneError shutdown();
 
@@ -64,6 +68,26 @@ public:
     Status status() const;
     static String status_to_string(Status status);
 
+    // Counters since the server was created, see OneServerStats. Times are in
+    // nanoseconds.
+    struct Stats {
+        uint64_t messages_in;
+        uint64_t messages_out;
+        uint64_t bytes_in;
+        uint64_t bytes_out;
+        uint64_t update_time;
+        uint64_t io_time;
+        uint64_t connection_time;
+        uint64_t encode_time;
+        uint64_t decode_time;
+        uint64_t dispatch_time;
+        uint64_t incoming_queue_peak;
+        uint64_t outgoing_queue_peak;
+    };
+    // Reads the counters without waiting for update. Fails with
+    // ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED if the server is not initialized.
+    OneError stats(Stats &stats) const;
+
     // Process pending received and outgoing messages. Any incoming messages are
     // validated according to the Arcus API version standard, and callbacks, if
     // set, are called. Messages without callbacks set are dropped and ignored.
@@ -74,15 +98,45 @@ public:
     // If a connection to a client fails, then the server waits for a new connection.
     // If a new client connects while an existing client is connected, then
     // the existing client is closed.
+    //
+    // With Threading::io_thread, errors of the background thread are returned
+    // by the next update. If the background thread is busy, update returns
+    // without waiting for it and the messages are dispatched by a later update.
     OneError update();
 
     //------------------------------------------------------------------------------
     // Property setters.
+    //
+    // The setters queue the change for the next update without taking the
+    // server lock, so they never wait for update or the I/O thread. Concurrent
+    // setter calls only wait for each other. They may be called before init,
+    // the changes are then applied by the first update. If the server is not
+    // updated often enough for the queue to drain, only the latest live state
+    // and status are kept.
 
     OneError set_live_state(int players, int max_players, const char *name,
                             const char *map, const char *mode, const char *version,
                             Object *additional_data);
 
+    // Coalesces live states that are set in quick succession. A live state
+    // change is only sent once no new change was set for window_ms, so that
+    // only the latest of a burst is sent, but no later than max_delay_ms after
+    // the first unsent change. A window of 0, the default, sends each change
+    // on the next update. Fails with
+    // ONE_ERROR_SERVER_INVALID_LIVE_STATE_COALESCING if max_delay_ms is less
+    // than window_ms.
+    OneError set_live_state_coalescing(unsigned int window_ms, unsigned int max_delay_ms);
+
+    // Advertises binary message payloads to the next connecting client,
+    // which are used instead of JSON if the client supports them. Off by
+    // default, since clients older than the SDK version that introduced
+    // binary payloads reject the handshake advertising them.
+    void set_binary_payloads(bool is_enabled);
+
+    // Fails with ONE_ERROR_SERVER_CONNECTION_NOT_READY if no client is
+    // connected and ready, and with ONE_ERROR_SERVER_PROPERTY_QUEUE_FULL if
+    // the queue did not drain since the previous sends. The message is dropped
+    // if the client disconnects before the next update.
     OneError send_reverse_metadata(Array *data);
 
     // Must match api standards.
@@ -96,28 +150,28 @@ public:
     // The `void *data` is the user provided and will be passed as the first argument
     // of the callback when invoked.
     // The `data` can be nullptr, the callback is responsible to use the data properly.
-    OneError set_soft_stop_callback(std::function<void(void *, int)> callback,
-                                    void *data);
+    OneError set_soft_stop_callback(void (*callback)(void *, int), void *data);
+
+    // The array and object callbacks below receive an Array * or Object * as
+    // the second argument, typed as in the C API.
 
     // set the callback for when a allocated message in received.
     // The `void *data` is the user provided and will be passed as the first argument
     // of the callback when invoked.
     // The `data` can be nullptr, the callback is responsible to use the data properly.
-    OneError set_allocated_callback(std::function<void(void *, Array *)> callback,
-                                    void *data);
+    OneError set_allocated_callback(void (*callback)(void *, void *), void *data);
 
     // set the callback for when a metadata message in received.
     // The `void *data` is the user provided and will be passed as the first argument
     // of the callback when invoked.
     // The `data` can be nullptr, the callback is responsible to use the data properly.
-    OneError set_metadata_callback(std::function<void(void *, Array *)> callback,
-                                   void *data);
+    OneError set_metadata_callback(void (*callback)(void *, void *), void *data);
 
     // set the callback for when a host_information message in received.
     // The `void *data` is the user provided and will be passed as the first argument
     // of the callback when invoked.
     // The `data` can be nullptr, the callback is responsible to use the data properly.
-    OneError set_host_information_callback(std::function<void(void *, Object *)> callback,
+    OneError set_host_information_callback(void (*callback)(void *, void *),
                                            void *data);
 
     // set the callback for when a application_instance_information message in
@@ -125,47 +179,87 @@ public:
     // argument of the callback when invoked. The `data` can be nullptr, the callback is
     // responsible to use the data properly.
     OneError set_application_instance_information_callback(
-        std::function<void(void *, Object *)> callback, void *data);
+        void (*callback)(void *, void *), void *data);
 
     // set the callback for when a custom command message in received.
     // The `void *data` is the user provided and will be passed as the first argument
     // of the callback when invoked.
     // The `data` can be nullptr, the callback is responsible to use the data properly.
-    OneError set_custom_command_callback(std::function<void(void *, Array *)> callback,
-                                         void *data);
+    OneError set_custom_command_callback(void (*callback)(void *, void *), void *data);
 
 private:
-    struct GameState {
-        GameState() : players(0), max_players(0), name(), map(), mode(), version() {}
-
-        int players;      // Game number of players.
-        int max_players;  // Game max number of players.
-        String name;      // Server name.
-        String map;       // Game map.
-        String mode;      // Game mode.
-        String version;   // Game version.
-
-        Object *additional_data;  // Optional extra fields.
+    // The live state set by set_live_state.
+    struct GameState;
+    // Flags for the GameState fields, to track which changed since the last
+    // send.
+    enum GameStateField : unsigned int {
+        players_field = 1 << 0,
+        max_players_field = 1 << 1,
+        name_field = 1 << 2,
+        map_field = 1 << 3,
+        mode_field = 1 << 4,
+        version_field = 1 << 5,
+        additional_data_field = 1 << 6,
+        all_fields = (1 << 7) - 1
     };
-    static bool game_states_changed(Server::GameState &new_state,
-                                    Server::GameState &old_state);
+
+    // The changes made by the property setters.
+    enum class PropertyType { live_state, application_instance_status, reverse_metadata };
+    // A change made by a property setter, queued for update.
+    struct PropertyChange;
+    // The latest changes that did not fit the queue, one of each type.
+    struct PropertyOverflow;
+    // Reserves a queue slot, calls fill to set it and queues it if fill
+    // succeeds. If the queue is full, fill overwrites the overflow of the
+    // type instead.
+    template <typename Fill>
+    OneError queue_property_change(PropertyType type, Fill fill);
+    // Applies the queued changes, then the overflow, in update_io.
+    void apply_property_changes();
+    void apply_property_change(PropertyChange &change);
+    // Applies a queued live state, marking the fields that differ as dirty.
+    void apply_live_state(PropertyChange &change);
 
     bool is_initialized() const;
     OneError listen();
+    // Socket I/O, message encoding and decoding. Incoming messages are left
+    // queued in the connection for dispatch_incoming_messages, or with
+    // Threading::io_thread, moved to the incoming handoff queue.
+    OneError update_io();
     OneError update_client_connection();
     OneError update_listen_socket();
+    OneError dispatch_incoming_messages();
     void close_client_connection();
 
+    // Background thread of Threading::io_thread.
+    void start_io_thread();
+    void stop_io_thread();
+    void run_io_thread();
+    // Moves incoming messages from the connection to the handoff queue, on the
+    // thread.
+    void hand_off_incoming_messages();
+    // Dispatches the handed off messages, in update.
+    OneError dispatch_handed_off_messages();
+
+    // Validates the message and calls its callback. Called without the server
+    // lock, so that the callback may call server functions.
     OneError process_incoming_message(const Message &message);
     // The server must have an active and ready listen connection in order to
     // send outgoing messages. If not, either ONE_ERROR_SERVER_CONNECTION_IS_NULLPTR or
     // ONE_ERROR_SERVER_CONNECTION_NOT_READY is returned and the message is
-    // not sent.
-    OneError process_outgoing_message(const Message &message);
+    // not sent. The message is moved into the outgoing queue.
+    OneError process_outgoing_message(Message &&message);
 
+    // Whether the dirty live state is to be sent, see set_live_state_coalescing.
+    bool is_live_state_due() const;
     OneError send_live_state();
     OneError send_application_instance_status();
 
+    // Serializes update's consumption of the incoming messages and their
+    // callbacks with the callback setters, init and shutdown. Locked before
+    // _server, never by the I/O thread. Recursive so that the callbacks can
+    // set callbacks.
+    std::recursive_mutex _dispatcher;
     mutable std::mutex _server;
 
     Logger _logger;
@@ -175,20 +269,66 @@ private:
     Socket *_listen_socket;
     Socket *_client_socket;
     Connection *_client_connection;
+    // Tracks the readiness of the sockets where supported, null otherwise.
+    Poller *_poller;
 
     bool _is_waiting_for_client;
 
-    GameState _game_state;
-    GameState _last_sent_game_state;
-    bool _game_state_was_set;
+    GameState *_game_state;
+    bool _is_game_state_set;
+    // The fields of the last live state sent to the current client, once
+    // _is_game_state_sent.
+    GameState *_last_sent_game_state;
+    bool _is_game_state_sent;
+    // GameStateField flags. Compared again with the last sent state before
+    // sending.
+    unsigned int _dirty_game_state_fields;
+    std::chrono::milliseconds _live_state_window;
+    std::chrono::milliseconds _live_state_max_delay;
+    std::chrono::steady_clock::time_point _live_state_first_change;  // Unsent.
+    std::chrono::steady_clock::time_point _live_state_last_change;
+
+    bool _is_binary_payloads_enabled;
 
     ApplicationInstanceStatus _status;
     bool _should_send_status;
 
-    ServerCallbacks _callbacks;
+    // Produced by the setters, consumed by update_io. Allocated with the
+    // server, so that the setters work before init.
+    SpscRing<PropertyChange> *_property_changes;
+    std::mutex _property_producer;  // Serializes the setters.
+    // Guarded by _property_producer, also taken by update_io to apply it.
+    PropertyOverflow *_property_overflow;
+    std::atomic<bool> _has_property_overflow;  // To check it without the lock.
+    // The additional data of the last queued live state, so that setting the
+    // same again is not copied. Guarded by _property_producer.
+    bool _has_queued_additional_data;
+    uint64_t _queued_additional_data_hash;
+    // Whether the client is ready, for the setters.
+    std::atomic<bool> _is_client_ready;
+
+    DispatchTable _dispatch;  // Callbacks of the incoming messages, see _dispatcher.
     std::chrono::steady_clock::time_point _last_listen_attempt_time;
 
-    Object *_additional_data;
+    Threading _threading;
+    std::thread _io_thread;
+    std::mutex _io_thread_mutex;  // Guards _should_stop_io_thread.
+    std::condition_variable _io_thread_wake;
+    bool _should_stop_io_thread;
+    // The thread and update exchange the following without the server lock,
+    // update and shutdown use them under _dispatcher.
+    SpscRing<Message> *_incoming_handoff;  // Decoded incoming messages.
+    Message *_dispatched_message;          // Popped from the handoff for dispatch.
+    std::atomic<OneError> _io_thread_error;  // Last error of the thread, for update.
+    std::atomic<bool> _should_close_client;  // Set by update on dispatch errors.
+
+    // Updated without the server lock, see Stats. The connection counters are
+    // kept here too, so that stats reads them without the connection.
+    StatCounter _update_time;
+    StatCounter _io_time;
+    StatCounter _dispatch_time;
+    Connection::Stats _connection_stats;
+    std::atomic<bool> _has_stats;  // Whether initialized, for stats.
 };
 
 }  // namespace one
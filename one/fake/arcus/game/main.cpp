@@ -36,9 +36,16 @@ int main(int argc, char **argv) {
         delay = std::chrono::seconds(second_delay);
     }
 
-    if (argc > 4) {
+    // Allocation stats are logged at this interval if not zero.
+    std::chrono::seconds stats_interval(0);
+    if (argc >= 5) {
+        unsigned int second_interval = strtol(argv[4], nullptr, 10);
+        stats_interval = std::chrono::seconds(second_interval);
+    }
+
+    if (argc > 5) {
         L_ERROR(
-            "invalid number of arguments provided. Maxmium of 3 arguments are "
+            "invalid number of arguments provided. Maxmium of 4 arguments are "
             "supported.");
         L_ERROR("\t first argument: an integer defining the port number to binds to.");
         L_ERROR(
@@ -47,9 +54,17 @@ int main(int argc, char **argv) {
         L_ERROR(
             "\t third argument: an integer defining transition delay in seconds between "
             "starting and online.");
+        L_ERROR(
+            "\t fourth argument: an integer defining the interval in seconds at which "
+            "the SDK allocation counts are logged, 0 to disable.");
         return -1;
     }
 
+    // Must be enabled before the SDK is used.
+    if (stats_interval.count() > 0) {
+        OneServerWrapper::enable_allocation_stats();
+    }
+
     Game game;
     if (!game.init(port, 16, "test game", "test map", "test mode", "test version",
                    delay)) {
@@ -69,11 +84,19 @@ int main(int argc, char **argv) {
     auto status = game.one_server_wrapper().status();
     log_status(status);
 
+    auto last_stats_time = std::chrono::steady_clock::now();
+
     while (true) {
         sleep(100);
         game.alter_game_state();
         game.update();
 
+        const auto now = std::chrono::steady_clock::now();
+        if (stats_interval.count() > 0 && now - last_stats_time >= stats_interval) {
+            last_stats_time = now;
+            L_INFO("allocation stats:\n" + OneServerWrapper::allocation_stats());
+        }
+
         auto old_status = status;
         status = game.one_server_wrapper().status();
         if (status != old_status) {
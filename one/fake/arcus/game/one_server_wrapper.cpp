@@ -219,6 +219,41 @@ void OneServerWrapper::update(bool quiet) {
     }
 }
 
+void OneServerWrapper::enable_allocation_stats() {
+    one_allocator_set_instrumentation(true);
+}
+
+std::string OneServerWrapper::allocation_stats() {
+    const struct {
+        OneAllocationSubsystem subsystem;
+        const char *name;
+    } subsystems[] = {{ONE_ALLOCATION_SUBSYSTEM_OTHER, "other"},
+                      {ONE_ALLOCATION_SUBSYSTEM_CODEC, "codec"},
+                      {ONE_ALLOCATION_SUBSYSTEM_CONNECTION, "connection"},
+                      {ONE_ALLOCATION_SUBSYSTEM_PAYLOAD, "payload"},
+                      {ONE_ALLOCATION_SUBSYSTEM_C_API, "c api"},
+                      {ONE_ALLOCATION_SUBSYSTEM_ALL, "all"}};
+
+    std::string result;
+    for (const auto &entry : subsystems) {
+        OneAllocationStats stats;
+        OneError err = one_allocator_stats(entry.subsystem, &stats);
+        if (one_is_error(err)) {
+            L_ERROR(one_error_text(err));
+            continue;
+        }
+        if (!result.empty()) {
+            result += "\n";
+        }
+        result += std::string("\t") + entry.name +
+                  ": allocations: " + std::to_string(stats.allocations) +
+                  ", frees: " + std::to_string(stats.frees) +
+                  ", bytes: " + std::to_string(stats.bytes) +
+                  ", peak bytes: " + std::to_string(stats.peak_bytes);
+    }
+    return result;
+}
+
 std::string OneServerWrapper::status_to_string(Status status) {
     switch (status) {
         case Status::uninitialized:
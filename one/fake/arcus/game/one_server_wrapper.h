@@ -54,6 +54,12 @@ public:
     bool init(unsigned int port, const AllocationHooks &hooks);
     void shutdown();
 
+    // Enables counting the allocations made by the SDK. Like the allocation
+    // hooks, it must be called before init.
+    static void enable_allocation_stats();
+    // Returns the SDK allocation counts per subsystem, one line each.
+    static std::string allocation_stats();
+
     // Must called often (e.g. each frame). Updates the Arcus Server, which
     // processes incoming and outgoing messages.
     void update(bool quiet);
@@ -44,8 +44,12 @@ T *create(Args &&...args) {
 }
 
 // Equivalent to the delete operator, but using the function set by set_free.
+// Like delete, does nothing if p is null.
 template <class T>
 void destroy(T *p) noexcept {
+    if (p == nullptr) {
+        return;
+    }
     p->~T();
     free(p);
 }
@@ -454,6 +454,25 @@ I3dPingError pingers_update(I3dPingersPtr pingers) {
     return p->update();
 }
 
+I3dPingError pingers_set_ping_interval(I3dPingersPtr pingers, unsigned int interval_ms) {
+    auto p = (Pingers *)(pingers);
+    if (p == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    p->set_ping_interval(interval_ms);
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError pingers_set_history_size(I3dPingersPtr pingers, unsigned int size) {
+    auto p = (Pingers *)(pingers);
+    if (p == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    return p->set_history_size(size);
+}
+
 I3dPingError pingers_status(I3dPingersPtr const pingers, I3dPingersStatus *status) {
     auto p = (Pingers *)(pingers);
     if (p == nullptr) {
@@ -549,6 +568,200 @@ I3dPingError i3d_ping_pingers_statistics(I3dPingersPtr pingers, unsigned int pos
     return I3D_PING_ERROR_NONE;
 }
 
+I3dPingError pingers_statistics_us(I3dPingersPtr pingers, unsigned int pos,
+                                   long long *last_time, double *average_time,
+                                   long long *min_time, long long *max_time,
+                                   double *median_time,
+                                   unsigned int *ping_response_count) {
+    auto p = (Pingers *)(pingers);
+    if (p == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (last_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (average_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (min_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (max_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (median_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (ping_response_count == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    int64_t time = 0;
+    auto err = p->last_time_us(pos, time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+    *last_time = static_cast<long long>(time);
+
+    err = p->average_time_us(pos, *average_time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    err = p->min_time_us(pos, time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+    *min_time = static_cast<long long>(time);
+
+    err = p->max_time_us(pos, time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+    *max_time = static_cast<long long>(time);
+
+    err = p->median_time_us(pos, *median_time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    err = p->ping_response_count(pos, *ping_response_count);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError pingers_percentiles_us(I3dPingersPtr pingers, unsigned int pos,
+                                    long long *p50_time, long long *p90_time,
+                                    long long *p99_time, double *jitter) {
+    auto p = (Pingers *)(pingers);
+    if (p == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (p50_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (p90_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (p99_time == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (jitter == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    int64_t time = 0;
+    auto err = p->percentile_time_us(pos, 50.0, time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+    *p50_time = static_cast<long long>(time);
+
+    err = p->percentile_time_us(pos, 90.0, time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+    *p90_time = static_cast<long long>(time);
+
+    err = p->percentile_time_us(pos, 99.0, time);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+    *p99_time = static_cast<long long>(time);
+
+    err = p->jitter_us(pos, *jitter);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError pingers_statistics_snapshot(I3dPingersPtr pingers,
+                                         I3dPingSiteStatistics *statistics,
+                                         unsigned int capacity, unsigned int *count) {
+    auto p = (Pingers *)(pingers);
+    if (p == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (statistics == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (count == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    const size_t size =
+        p->visit_snapshot([&](size_t pos, const Pingers::Statistics &site) {
+            if (capacity <= pos) {
+                return;
+            }
+
+            auto &s = statistics[pos];
+            s.last_time = static_cast<long long>(site.last_time);
+            s.average_time = site.average_time;
+            s.min_time = static_cast<long long>(site.min_time);
+            s.max_time = static_cast<long long>(site.max_time);
+            s.median_time = site.median_time;
+            s.p90_time = static_cast<long long>(site.p90_time);
+            s.p99_time = static_cast<long long>(site.p99_time);
+            s.jitter = site.jitter;
+            s.ping_response_count = site.ping_response_count;
+            s.ping_sent_count = site.ping_sent_count;
+            s.ping_lost_count = site.ping_lost_count;
+        });
+
+    *count = static_cast<unsigned int>(size);
+    if (capacity < size) {
+        return I3D_PING_ERROR_VALIDATION_BUFFER_IS_TOO_SMALL;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError pingers_loss(I3dPingersPtr pingers, unsigned int pos,
+                          unsigned int *ping_sent_count, unsigned int *ping_lost_count) {
+    auto p = (Pingers *)(pingers);
+    if (p == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (ping_sent_count == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    if (ping_lost_count == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    auto err = p->ping_sent_count(pos, *ping_sent_count);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    err = p->ping_lost_count(pos, *ping_lost_count);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
 I3dPingError at_least_one_site_has_been_pinged(I3dPingersPtr pingers, bool *result) {
     auto p = (Pingers *)(pingers);
     if (p == nullptr) {
@@ -828,6 +1041,15 @@ I3dPingError i3d_ping_pingers_status(I3dPingersPtr const pingers,
     return ping::pingers_status(pingers, status);
 }
 
+I3dPingError i3d_ping_pingers_set_ping_interval(I3dPingersPtr pingers,
+                                                unsigned int interval_ms) {
+    return ping::pingers_set_ping_interval(pingers, interval_ms);
+}
+
+I3dPingError i3d_ping_pingers_set_history_size(I3dPingersPtr pingers, unsigned int size) {
+    return ping::pingers_set_history_size(pingers, size);
+}
+
 I3dPingError i3d_ping_pingers_size(I3dPingersPtr pingers, unsigned int *size) {
     return ping::pingers_size(pingers, size);
 }
@@ -842,6 +1064,35 @@ I3dPingError i3d_ping_pingers_statistics(I3dPingersPtr pingers, unsigned int pos
                                              ping_response_count);
 }
 
+I3dPingError i3d_ping_pingers_statistics_us(I3dPingersPtr pingers, unsigned int pos,
+                                            long long *last_time, double *average_time,
+                                            long long *min_time, long long *max_time,
+                                            double *median_time,
+                                            unsigned int *ping_response_count) {
+    return ping::pingers_statistics_us(pingers, pos, last_time, average_time, min_time,
+                                       max_time, median_time, ping_response_count);
+}
+
+I3dPingError i3d_ping_pingers_percentiles_us(I3dPingersPtr pingers, unsigned int pos,
+                                             long long *p50_time, long long *p90_time,
+                                             long long *p99_time, double *jitter) {
+    return ping::pingers_percentiles_us(pingers, pos, p50_time, p90_time, p99_time,
+                                        jitter);
+}
+
+I3dPingError i3d_ping_pingers_statistics_snapshot(I3dPingersPtr pingers,
+                                                  I3dPingSiteStatistics *statistics,
+                                                  unsigned int capacity,
+                                                  unsigned int *count) {
+    return ping::pingers_statistics_snapshot(pingers, statistics, capacity, count);
+}
+
+I3dPingError i3d_ping_pingers_loss(I3dPingersPtr pingers, unsigned int pos,
+                                   unsigned int *ping_sent_count,
+                                   unsigned int *ping_lost_count) {
+    return ping::pingers_loss(pingers, pos, ping_sent_count, ping_lost_count);
+}
+
 I3dPingError i3d_ping_pingers_at_least_one_site_has_been_pinged(I3dPingersPtr pingers,
                                                                 bool *result) {
     return ping::at_least_one_site_has_been_pinged(pingers, result);
@@ -315,6 +315,20 @@ I3D_PING_EXPORT void i3d_ping_pingers_destroy(I3dPingersPtr pingers);
 /// @param pingers A non-null pingers pointer. Thread-safe.
 I3D_PING_EXPORT I3dPingError i3d_ping_pingers_update(I3dPingersPtr pingers);
 
+/// Sets the minimum time between two pings sent to a site. Several pings can be
+/// in flight for each site, a ping without a reply after two seconds is lost.
+/// @param pingers A non-null pingers pointer. Thread-safe.
+/// @param interval_ms The interval in milliseconds, 100 by default.
+I3D_PING_EXPORT I3dPingError i3d_ping_pingers_set_ping_interval(I3dPingersPtr pingers,
+                                                                unsigned int interval_ms);
+
+/// Sets the number of the most recent ping times of a site the median, percentiles
+/// and jitter are computed over.
+/// @param pingers A non-null pingers pointer. Thread-safe.
+/// @param size The number of times, in [1, 128], 10 by default.
+I3D_PING_EXPORT I3dPingError i3d_ping_pingers_set_history_size(I3dPingersPtr pingers,
+                                                               unsigned int size);
+
 /// Obtains the status of the pingers. Thread-safe. The passed in pointer is set
 /// to the status value.
 /// @param pingers A non-null pingers pointer.
@@ -343,6 +357,78 @@ I3D_PING_EXPORT I3dPingError i3d_ping_pingers_statistics(
     I3dPingersPtr pingers, unsigned int pos, int *last_time, double *average_time,
     int *min_time, int *max_time, double *median_time, unsigned int *ping_response_count);
 
+/// Get the ping statistics of the site at the given position in the site list, as
+/// i3d_ping_pingers_statistics, with the times in microseconds.
+/// @param pingers A non-null pingers pointer. Thread-safe.
+/// @param pos The position in the list . Must be less than
+/// i3d_ping_pingers_size.
+/// @param last_time Non-null pointer to set the last_time on.
+/// @param average_time Non-null pointer to set the average_time on.
+/// @param min_time Non-null pointer to set the min_time on.
+/// @param max_time Non-null pointer to set the max_time on.
+/// @param median_time Non-null pointer to set the median_time on.
+/// @param ping_response_count Non-null pointer to set the ping response count on.
+I3D_PING_EXPORT I3dPingError i3d_ping_pingers_statistics_us(
+    I3dPingersPtr pingers, unsigned int pos, long long *last_time, double *average_time,
+    long long *min_time, long long *max_time, double *median_time,
+    unsigned int *ping_response_count);
+
+/// Get the percentiles and jitter of the recent ping times, see
+/// i3d_ping_pingers_set_history_size, of the site at the given position in the site
+/// list, in microseconds. The percentiles are nearest-rank, the jitter is the mean
+/// difference between consecutive times.
+/// @param pingers A non-null pingers pointer. Thread-safe.
+/// @param pos The position in the list . Must be less than
+/// i3d_ping_pingers_size.
+/// @param p50_time Non-null pointer to set the 50th percentile on.
+/// @param p90_time Non-null pointer to set the 90th percentile on.
+/// @param p99_time Non-null pointer to set the 99th percentile on.
+/// @param jitter Non-null pointer to set the jitter on.
+I3D_PING_EXPORT I3dPingError i3d_ping_pingers_percentiles_us(
+    I3dPingersPtr pingers, unsigned int pos, long long *p50_time, long long *p90_time,
+    long long *p99_time, double *jitter);
+
+/// The statistics of a site, see i3d_ping_pingers_statistics_snapshot. Times are in
+/// microseconds, -1 while not available.
+typedef struct I3dPingSiteStatistics {
+    long long last_time;
+    double average_time;
+    long long min_time;
+    long long max_time;
+    double median_time;
+    long long p90_time;
+    long long p99_time;
+    double jitter;  ///< Mean difference between consecutive times.
+    unsigned int ping_response_count;
+    unsigned int ping_sent_count;  ///< Including the pings in flight.
+    unsigned int ping_lost_count;
+} I3dPingSiteStatistics;
+
+/// Gets the statistics of all the sites in one call, as published by the last
+/// i3d_ping_pingers_update, in the order of the site list. Thread-safe, and does
+/// not lock the pingers or allocate: cheap enough to rank the sites every frame.
+/// @param pingers A non-null pingers pointer.
+/// @param statistics A non-null array of at least capacity statistics to set.
+/// @param capacity The size of the statistics array.
+/// @param count Non-null pointer to set the number of sites on. If it is more than
+/// the capacity, I3D_PING_ERROR_VALIDATION_BUFFER_IS_TOO_SMALL is returned and only
+/// the first capacity statistics are set.
+I3D_PING_EXPORT I3dPingError i3d_ping_pingers_statistics_snapshot(
+    I3dPingersPtr pingers, I3dPingSiteStatistics *statistics, unsigned int capacity,
+    unsigned int *count);
+
+/// Get the pings sent to the site at the given position in the site list, and those
+/// lost. The pings in flight are counted as sent only.
+/// @param pingers A non-null pingers pointer. Thread-safe.
+/// @param pos The position in the list . Must be less than
+/// i3d_ping_pingers_size.
+/// @param ping_sent_count Non-null pointer to set the ping sent count on.
+/// @param ping_lost_count Non-null pointer to set the ping lost count on.
+I3D_PING_EXPORT I3dPingError i3d_ping_pingers_loss(I3dPingersPtr pingers,
+                                                   unsigned int pos,
+                                                   unsigned int *ping_sent_count,
+                                                   unsigned int *ping_lost_count);
+
 /// Gets true if at least one site was pinged recently.
 /// @param pingers A non-null pingers pointer. Thread-safe.
 /// @param result Non-null pointer to set the result on.
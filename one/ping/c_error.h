@@ -56,6 +56,8 @@ typedef enum I3dPingError {
     I3D_PING_ERROR_PINGER_INVALID_TIME = 601,
     I3D_PING_ERROR_PINGER_ALREADY_INITIALIZED = 602,
     I3D_PING_ERROR_PINGER_IS_UNINITIALIZED = 603,
+    I3D_PING_ERROR_PINGER_INVALID_HISTORY_SIZE = 604,
+    I3D_PING_ERROR_PINGER_INVALID_PERCENTILE = 605,
     I3D_PING_ERROR_PINGERS_NOT_INITIALIZED = 700,
     I3D_PING_ERROR_PINGERS_ALREADY_INITIALIZED = 701,
     I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE = 702,
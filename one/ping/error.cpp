@@ -64,6 +64,8 @@ const char *error_text(I3dPingError err) {
         {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGER_DIVISION_BY_ZERO)},
         {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGER_INVALID_TIME)},
         {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGER_IS_UNINITIALIZED)},
+        {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGER_INVALID_HISTORY_SIZE)},
+        {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGER_INVALID_PERCENTILE)},
         {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGERS_NOT_INITIALIZED)},
         {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGERS_ALREADY_INITIALIZED)},
         {I3D_PING_ERROR_SYMBOL_STRING_PAIR(I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE)}};
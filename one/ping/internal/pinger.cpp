@@ -1,95 +1,248 @@
 #include <one/ping/internal/pinger.h>
 
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <algorithm>
 #include <limits>
 
-#define I3D_PING_MEDIAN_HISTORY_SIZE 10
-
 namespace i3d {
 namespace ping {
 
+namespace {
+// Time after which a ping without reply is considered lost.
+constexpr std::chrono::seconds ping_timeout(2);
+
+constexpr int64_t microseconds_per_millisecond = 1000;
+
+// The data of a ping is the base data followed by its sequence number and a
+// trailing '\0'.
+constexpr char ping_base_data[] = "Hello Arcus ";
+constexpr size_t ping_base_size = sizeof(ping_base_data) - 1;
+}  // namespace
+
+constexpr size_t Pinger::max_pings_in_flight;
+constexpr unsigned int Pinger::default_interval_ms;
+
 Pinger::Pinger()
-    : _last_time(-1)
+    : _destination{}
+    , _sequence(0)
+    , _pings{}
+    , _interval(default_interval_ms)
+    , _time_next_send()
+    , _ping_sent_count(0)
+    , _ping_lost_count(0)
+    , _last_time(-1)
     , _total_time(0)
     , _ping_response_count(0)
     , _min_time(-1)
     , _max_time(-1)
     , _status(Status::uninitialized) {}
 
-I3dPingError Pinger::update() {
+I3dPingError Pinger::init(const char *ipv4) {
+    if (_status == Status::initialized) {
+        return I3D_PING_ERROR_PINGER_ALREADY_INITIALIZED;
+    }
+
+    if (ipv4 == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
+
+    // The UDP port is 3075 by default on all the ping sites.
+    const int port = 3075;
+    auto err = UdpSocket::address(ipv4, port, _destination);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    _status = Status::initialized;
+    return I3D_PING_ERROR_NONE;
+}
+
+void Pinger::set_interval(std::chrono::milliseconds interval) {
+    _time_next_send += interval - _interval;
+    _interval = interval;
+}
+
+I3dPingError Pinger::set_history_size(size_t size) {
+    return _history.set_size(size);
+}
+
+bool Pinger::prepare_ping(Datagram &datagram) {
     if (_status != Status::initialized) {
-        return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
+        return false;
     }
 
-    int time = 0;
+    const auto now = std::chrono::steady_clock::now();
+    expire_pings(now);
 
-    // If the socket has valid time, we update the average and latest values,
-    // because the socket will reset itself automatically on the next update.
-    auto err = _socket.time_milliseconds(time);
-    if (!i3d_ping_is_error(err)) {
-        // Reset the values when the values are too big for unsigned int.
-        // https:://stackoverflow.com/questions/27442885/syntax-error-with-stdnumeric-limitsmax
-        const unsigned int numerical_max = (std::numeric_limits<unsigned int>::max)();
-        if (_total_time == numerical_max || _ping_response_count == numerical_max) {
-            reset();
-        }
+    if (now < _time_next_send) {
+        return false;
+    }
 
-        _last_time = time;
-        _total_time += time;
-        ++_ping_response_count;
+    if (_pings[(_sequence + 1) % max_pings_in_flight].is_in_flight) {
+        return false;
+    }
 
-        if (_max_time < time) {
-            _max_time = time;
-        }
+    // The data must have a size greater than 2, since the ping endpoint mirrors
+    // it with the first two bytes flipped to '\0'. The trailing '\0' is sent.
+    ++_sequence;
+    const int length = snprintf(datagram.data, sizeof(datagram.data), "%s%lu",
+                                ping_base_data, _sequence);
+    datagram.address = _destination;
+    datagram.size = static_cast<size_t>(length) + 1;
+    return true;
+}
 
-        // To avoid edge case just after a reset were min is -1.
-        if (_min_time == -1) {
-            _min_time = time;
-        }
+void Pinger::ping_sent() {
+    auto &ping = _pings[_sequence % max_pings_in_flight];
+    ping.sequence = _sequence;
+    ping.is_in_flight = true;
+    ping.time_send = std::chrono::steady_clock::now();
+    _time_next_send = ping.time_send + _interval;
+    ++_ping_sent_count;
+}
 
-        if (time < _min_time) {
-            _min_time = time;
-        }
+bool Pinger::receive(const Datagram &datagram) {
+    // The ping endpoint mirrors the data with the first two bytes changed to
+    // '\0', followed by the sequence number of the ping.
+    const char *data = datagram.data;
+    if (datagram.size <= ping_base_size + 1 || data[datagram.size - 1] != '\0') {
+        return false;
+    }
+    if (data[0] != '\0' || data[1] != '\0') {
+        return false;
+    }
+    if (memcmp(data + 2, ping_base_data + 2, ping_base_size - 2) != 0) {
+        return false;
+    }
+
+    const char *digits = data + ping_base_size;
+    if (!isdigit(static_cast<unsigned char>(digits[0]))) {
+        return false;
+    }
+    char *end = nullptr;
+    const unsigned long sequence = strtoul(digits, &end, 10);
+    if (end != data + datagram.size - 1) {
+        return false;
+    }
+
+    // Replies to pings lost, or not sent, are ignored.
+    auto &ping = _pings[sequence % max_pings_in_flight];
+    if (!ping.is_in_flight || ping.sequence != sequence) {
+        return false;
+    }
+    ping.is_in_flight = false;
+
+    // The receive time can precede the send time by the clock conversion of
+    // the kernel timestamp.
+    const auto round_trip = (std::max)(datagram.time - ping.time_send,
+                                       std::chrono::steady_clock::duration::zero());
+    if (ping_timeout <= round_trip) {
+        ++_ping_lost_count;
+        return true;
+    }
 
-        // To avoid _history to be ever increasing.
-        if (_history.size() == I3D_PING_MEDIAN_HISTORY_SIZE) {
-            _history.pop_front();
+    // Divided by two to take into account the round trip time.
+    record_time(
+        std::chrono::duration_cast<std::chrono::microseconds>(round_trip).count() / 2);
+    return true;
+}
+
+void Pinger::expire_pings(std::chrono::steady_clock::time_point now) {
+    for (auto &ping : _pings) {
+        if (ping.is_in_flight && ping_timeout <= now - ping.time_send) {
+            ping.is_in_flight = false;
+            ++_ping_lost_count;
         }
+    }
+}
 
-        _history.push_back(time);
+void Pinger::record_time(int64_t time) {
+    // Reset the values when the values are too big for unsigned int.
+    // https:://stackoverflow.com/questions/27442885/syntax-error-with-stdnumeric-limitsmax
+    const unsigned int numerical_max = (std::numeric_limits<unsigned int>::max)();
+    if (_ping_response_count == numerical_max || _ping_sent_count == numerical_max) {
+        reset();
     }
 
-    // The socket is reset after an error.
-    err = _socket.update();
+    _last_time = time;
+    _total_time += time;
+    ++_ping_response_count;
+
+    if (_max_time < time) {
+        _max_time = time;
+    }
+
+    // To avoid edge case just after a reset were min is -1.
+    if (_min_time == -1) {
+        _min_time = time;
+    }
+
+    if (time < _min_time) {
+        _min_time = time;
+    }
+
+    _history.push(time);
+}
+
+I3dPingError Pinger::last_time(int &duration_ms) const {
+    int64_t duration_us = 0;
+    auto err = last_time_us(duration_us);
     if (i3d_ping_is_error(err)) {
-        reset();
         return err;
     }
 
+    duration_ms = static_cast<int>(duration_us / microseconds_per_millisecond);
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError Pinger::init(const char *ipv4) {
-    if (_status == Status::initialized) {
-        return I3D_PING_ERROR_PINGER_ALREADY_INITIALIZED;
+I3dPingError Pinger::average_time(double &duration_ms) const {
+    double duration_us = 0.0;
+    auto err = average_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
     }
 
-    if (ipv4 == nullptr) {
-        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    duration_ms = duration_us / microseconds_per_millisecond;
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pinger::min_time(int &duration_ms) const {
+    int64_t duration_us = 0;
+    auto err = min_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
     }
 
-    // The UDP port is 3075 by default on all the ping sites.
-    const int port = 3075;
-    auto err = _socket.init(ipv4, port);
+    duration_ms = static_cast<int>(duration_us / microseconds_per_millisecond);
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pinger::max_time(int &duration_ms) const {
+    int64_t duration_us = 0;
+    auto err = max_time_us(duration_us);
     if (i3d_ping_is_error(err)) {
         return err;
     }
 
-    _status = Status::initialized;
+    duration_ms = static_cast<int>(duration_us / microseconds_per_millisecond);
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError Pinger::last_time(int &duration_ms) const {
+I3dPingError Pinger::median_time(double &duration_ms) const {
+    double duration_us = 0.0;
+    auto err = median_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    duration_ms = duration_us / microseconds_per_millisecond;
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pinger::last_time_us(int64_t &duration_us) const {
     if (_status != Status::initialized) {
         return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
     }
@@ -98,11 +251,11 @@ I3dPingError Pinger::last_time(int &duration_ms) const {
         return I3D_PING_ERROR_PINGER_INVALID_TIME;
     }
 
-    duration_ms = _last_time;
+    duration_us = _last_time;
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError Pinger::average_time(double &duration_ms) const {
+I3dPingError Pinger::average_time_us(double &duration_us) const {
     if (_status != Status::initialized) {
         return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
     }
@@ -113,11 +266,11 @@ I3dPingError Pinger::average_time(double &duration_ms) const {
         return err;
     }
 
-    duration_ms = average;
+    duration_us = average;
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError Pinger::min_time(int &duration_ms) const {
+I3dPingError Pinger::min_time_us(int64_t &duration_us) const {
     if (_status != Status::initialized) {
         return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
     }
@@ -126,11 +279,11 @@ I3dPingError Pinger::min_time(int &duration_ms) const {
         return I3D_PING_ERROR_PINGER_INVALID_TIME;
     }
 
-    duration_ms = _min_time;
+    duration_us = _min_time;
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError Pinger::max_time(int &duration_ms) const {
+I3dPingError Pinger::max_time_us(int64_t &duration_us) const {
     if (_status != Status::initialized) {
         return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
     }
@@ -139,23 +292,32 @@ I3dPingError Pinger::max_time(int &duration_ms) const {
         return I3D_PING_ERROR_PINGER_INVALID_TIME;
     }
 
-    duration_ms = _max_time;
+    duration_us = _max_time;
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError Pinger::median_time(double &duration_ms) const {
+I3dPingError Pinger::median_time_us(double &duration_us) const {
     if (_status != Status::initialized) {
         return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
     }
 
-    double median = 0.0;
-    auto err = compute_median(_history, median);
-    if (i3d_ping_is_error(err)) {
-        return err;
+    return _history.median(duration_us);
+}
+
+I3dPingError Pinger::percentile_time_us(double percentile, int64_t &duration_us) const {
+    if (_status != Status::initialized) {
+        return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
     }
 
-    duration_ms = median;
-    return I3D_PING_ERROR_NONE;
+    return _history.percentile(percentile, duration_us);
+}
+
+I3dPingError Pinger::jitter_us(double &jitter_us) const {
+    if (_status != Status::initialized) {
+        return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
+    }
+
+    return _history.jitter(jitter_us);
 }
 
 I3dPingError Pinger::ping_response_count(unsigned int &response_count) const {
@@ -167,7 +329,33 @@ I3dPingError Pinger::ping_response_count(unsigned int &response_count) const {
     return I3D_PING_ERROR_NONE;
 }
 
+I3dPingError Pinger::ping_sent_count(unsigned int &sent_count) const {
+    if (_status != Status::initialized) {
+        return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
+    }
+
+    sent_count = _ping_sent_count;
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pinger::ping_lost_count(unsigned int &lost_count) const {
+    if (_status != Status::initialized) {
+        return I3D_PING_ERROR_PINGER_IS_UNINITIALIZED;
+    }
+
+    lost_count = _ping_lost_count;
+    return I3D_PING_ERROR_NONE;
+}
+
 void Pinger::reset() {
+    // The pings in flight are still counted when replied or lost.
+    _ping_sent_count = 0;
+    for (const auto &ping : _pings) {
+        if (ping.is_in_flight) {
+            ++_ping_sent_count;
+        }
+    }
+    _ping_lost_count = 0;
     _last_time = -1;
     _total_time = 0;
     _ping_response_count = 0;
@@ -176,39 +364,13 @@ void Pinger::reset() {
     _history.clear();
 }
 
-I3dPingError Pinger::compute_average(unsigned int total_time, unsigned int response_count,
+I3dPingError Pinger::compute_average(uint64_t total_time, unsigned int response_count,
                                      double &average) const {
-    if (total_time == 0) {
-        return I3D_PING_ERROR_PINGER_INVALID_TIME;
-    }
-
     if (response_count == 0) {
-        return I3D_PING_ERROR_PINGER_DIVISION_BY_ZERO;
-    }
-
-    average = static_cast<double>(total_time) / static_cast<double>(response_count);
-    return I3D_PING_ERROR_NONE;
-}
-
-I3dPingError Pinger::compute_median(const List<int> &history, double &median_time) const {
-    if (_history.empty()) {
         return I3D_PING_ERROR_PINGER_INVALID_TIME;
     }
 
-    Vector<int> sample = {history.cbegin(), history.cend()};
-    std::sort(sample.begin(), sample.end());
-
-    // If even, take the mean of the two central values.
-    if (sample.size() % 2 == 0) {
-        int center_pos = (sample.size() / 2) - 1;
-        int center_pos_2 = sample.size() / 2;
-
-        median_time =
-            static_cast<double>(sample[center_pos] + sample[center_pos_2]) / 2.0;
-    } else {  // If odd, take the central value.
-        median_time = sample[sample.size() / 2];
-    }
-
+    average = static_cast<double>(total_time) / static_cast<double>(response_count);
     return I3D_PING_ERROR_NONE;
 }
 
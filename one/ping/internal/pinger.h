@@ -1,29 +1,77 @@
 #pragma once
 
+#include <stdint.h>
+#include <chrono>
+
 #include <one/ping/types.h>
 #include <one/ping/error.h>
+#include <one/ping/internal/time_window.h>
 #include <one/ping/internal/udp_socket.h>
 
 namespace i3d {
 namespace ping {
 
+// Pings a site through the UdpSocket shared by all sites, see Pingers, and
+// keeps the statistics of its replies. Several pings can be in flight, sent at
+// the ping interval. A ping without a reply within the timeout is lost.
 class Pinger final {
 public:
+    // Pings in flight at most, new pings wait for a reply or the timeout.
+    static constexpr size_t max_pings_in_flight = 8;
+    // Time between the pings by default.
+    static constexpr unsigned int default_interval_ms = 100;
+
     Pinger();
     Pinger(const Pinger &) = default;
     Pinger &operator=(const Pinger &) = delete;
     ~Pinger() = default;
 
-    I3dPingError update();
-
     I3dPingError init(const char *ipv4);
 
+    const sockaddr_in &destination() const {
+        return _destination;
+    }
+
+    // Minimum time between two pings sent. Applies to the next ping too.
+    void set_interval(std::chrono::milliseconds interval);
+
+    // Number of the most recent times the median, percentiles and jitter are
+    // computed over, in [1, TimeWindow::max_size].
+    I3dPingError set_history_size(size_t size);
+
+    // Writes the next ping to the datagram if the interval since the last one
+    // elapsed and there is room in flight. Returns whether it did. ping_sent
+    // must be called once the datagram is sent.
+    bool prepare_ping(Datagram &datagram);
+    void ping_sent();
+
+    // Handles a datagram received from the destination. Returns whether it is
+    // the reply to a ping in flight, in which case its time is recorded, or
+    // the ping counted lost if the reply came after the timeout.
+    bool receive(const Datagram &datagram);
+
+    // The time of a ping is half its round trip, measured with a monotonic
+    // clock. The times are kept in microseconds, and truncated for the
+    // millisecond getters.
     I3dPingError last_time(int &duration_ms) const;
     I3dPingError average_time(double &duration_ms) const;
     I3dPingError min_time(int &duration_ms) const;
     I3dPingError max_time(int &duration_ms) const;
     I3dPingError median_time(double &duration_ms) const;
+    I3dPingError last_time_us(int64_t &duration_us) const;
+    I3dPingError average_time_us(double &duration_us) const;
+    I3dPingError min_time_us(int64_t &duration_us) const;
+    I3dPingError max_time_us(int64_t &duration_us) const;
+    I3dPingError median_time_us(double &duration_us) const;
+    // The nearest-rank percentile of the recent times, e.g. 99 for p99.
+    I3dPingError percentile_time_us(double percentile, int64_t &duration_us) const;
+    // The mean difference between consecutive recent times.
+    I3dPingError jitter_us(double &jitter_us) const;
     I3dPingError ping_response_count(unsigned int &response_count) const;
+    // The pings sent and those lost, those in flight are neither replied nor
+    // lost yet.
+    I3dPingError ping_sent_count(unsigned int &sent_count) const;
+    I3dPingError ping_lost_count(unsigned int &lost_count) const;
 
     enum class Status { uninitialized, initialized };
 
@@ -32,20 +80,39 @@ public:
     }
 
 private:
+    // Counts the pings in flight for longer than the timeout as lost.
+    void expire_pings(std::chrono::steady_clock::time_point now);
+    void record_time(int64_t time);
     void reset();
 
-    I3dPingError compute_average(unsigned int total_time, unsigned int response_count,
+    I3dPingError compute_average(uint64_t total_time, unsigned int response_count,
                                  double &average) const;
-    I3dPingError compute_median(const List<int> &history, double &median_time) const;
 
-    UdpSocket _socket;
+    sockaddr_in _destination;
+
+    // A ping, in the slot of its sequence number modulo max_pings_in_flight.
+    // The sequence number tags the data, which the site mirrors back.
+    struct Ping {
+        unsigned long sequence;
+        bool is_in_flight;
+        std::chrono::steady_clock::time_point time_send;
+    };
+
+    // The sequence number of the last ping prepared.
+    unsigned long _sequence;
+    Ping _pings[max_pings_in_flight];
+    std::chrono::milliseconds _interval;
+    std::chrono::steady_clock::time_point _time_next_send;
+    unsigned int _ping_sent_count;
+    unsigned int _ping_lost_count;
 
-    int _last_time;
-    unsigned int _total_time;
+    // In microseconds, -1 if there is none.
+    int64_t _last_time;
+    uint64_t _total_time;
     unsigned int _ping_response_count;
-    int _min_time;
-    int _max_time;
-    List<int> _history;
+    int64_t _min_time;
+    int64_t _max_time;
+    TimeWindow _history;
 
     Status _status;
 };
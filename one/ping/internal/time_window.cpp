@@ -0,0 +1,122 @@
+#include <one/ping/internal/time_window.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace i3d {
+namespace ping {
+
+namespace {
+int64_t difference(int64_t a, int64_t b) {
+    return (a < b) ? b - a : a - b;
+}
+}  // namespace
+
+constexpr size_t TimeWindow::max_size;
+constexpr size_t TimeWindow::default_size;
+
+TimeWindow::TimeWindow()
+    : _ring{}, _sorted{}, _size(default_size), _first(0), _count(0), _jitter_total(0) {}
+
+I3dPingError TimeWindow::set_size(size_t size) {
+    if (size == 0 || max_size < size) {
+        return I3D_PING_ERROR_PINGER_INVALID_HISTORY_SIZE;
+    }
+
+    // Pushed again from the oldest one kept.
+    int64_t samples[max_size];
+    const size_t kept = (std::min)(size, _count);
+    for (size_t i = 0; i < kept; ++i) {
+        samples[i] = _ring[(_first + _count - kept + i) % _size];
+    }
+
+    clear();
+    _size = size;
+    for (size_t i = 0; i < kept; ++i) {
+        push(samples[i]);
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+void TimeWindow::push(int64_t sample) {
+    if (_count == _size) {
+        const int64_t oldest = _ring[_first];
+        _first = (_first + 1) % _size;
+        --_count;
+        remove_sorted(oldest);
+        if (0 < _count) {
+            _jitter_total -= difference(_ring[_first], oldest);
+        }
+    }
+
+    if (0 < _count) {
+        _jitter_total += difference(sample, _ring[(_first + _count - 1) % _size]);
+    }
+
+    _ring[(_first + _count) % _size] = sample;
+    ++_count;
+    insert_sorted(sample);
+}
+
+void TimeWindow::clear() {
+    _first = 0;
+    _count = 0;
+    _jitter_total = 0;
+}
+
+I3dPingError TimeWindow::median(double &median) const {
+    if (_count == 0) {
+        return I3D_PING_ERROR_PINGER_INVALID_TIME;
+    }
+
+    // If even, take the mean of the two central values.
+    if (_count % 2 == 0) {
+        median = static_cast<double>(_sorted[_count / 2 - 1] + _sorted[_count / 2]) / 2.0;
+    } else {  // If odd, take the central value.
+        median = static_cast<double>(_sorted[_count / 2]);
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError TimeWindow::percentile(double percentile, int64_t &sample) const {
+    if (!(0.0 < percentile && percentile <= 100.0)) {
+        return I3D_PING_ERROR_PINGER_INVALID_PERCENTILE;
+    }
+
+    if (_count == 0) {
+        return I3D_PING_ERROR_PINGER_INVALID_TIME;
+    }
+
+    const auto rank = static_cast<size_t>(ceil(percentile * _count / 100.0));
+    sample = _sorted[(std::max)(rank, size_t(1)) - 1];
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError TimeWindow::jitter(double &jitter) const {
+    if (_count < 2) {
+        return I3D_PING_ERROR_PINGER_INVALID_TIME;
+    }
+
+    jitter = static_cast<double>(_jitter_total) / static_cast<double>(_count - 1);
+    return I3D_PING_ERROR_NONE;
+}
+
+// The sorted samples hold _count samples once removed or inserted.
+
+void TimeWindow::remove_sorted(int64_t sample) {
+    int64_t *end = _sorted + _count + 1;
+    int64_t *it = std::lower_bound(_sorted, end, sample);
+    std::copy(it + 1, end, it);
+}
+
+void TimeWindow::insert_sorted(int64_t sample) {
+    int64_t *end = _sorted + _count - 1;
+    int64_t *it = std::upper_bound(_sorted, end, sample);
+    std::copy_backward(it, end, end + 1);
+    *it = sample;
+}
+
+}  // namespace ping
+}  // namespace i3d
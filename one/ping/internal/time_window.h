@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <one/ping/error.h>
+
+namespace i3d {
+namespace ping {
+
+// The most recent ping times of a site, in a fixed-size ring. A sorted copy of
+// the samples is kept up to date as they are added, so that the median and the
+// percentiles are read without sorting. Adding a sample costs O(size), reading
+// any statistic O(1), and neither allocates.
+class TimeWindow final {
+public:
+    static constexpr size_t max_size = 128;
+    static constexpr size_t default_size = 10;
+
+    TimeWindow();
+    TimeWindow(const TimeWindow &) = default;
+    TimeWindow &operator=(const TimeWindow &) = default;
+    ~TimeWindow() = default;
+
+    // Number of samples kept, in [1, max_size]. The most recent samples that
+    // fit the new size are kept.
+    I3dPingError set_size(size_t size);
+    size_t size() const {
+        return _size;
+    }
+
+    // Number of samples currently in the window.
+    size_t count() const {
+        return _count;
+    }
+
+    void push(int64_t sample);
+    void clear();
+
+    // The mean of the two central samples if their count is even.
+    I3dPingError median(double &median) const;
+
+    // The nearest-rank percentile, percentile in (0, 100], e.g. 90 for p90.
+    I3dPingError percentile(double percentile, int64_t &sample) const;
+
+    // The mean absolute difference between consecutive samples. Requires two
+    // samples.
+    I3dPingError jitter(double &jitter) const;
+
+private:
+    void remove_sorted(int64_t sample);
+    void insert_sorted(int64_t sample);
+
+    // The samples from oldest to most recent, starting at _first.
+    int64_t _ring[max_size];
+    int64_t _sorted[max_size];
+    size_t _size;
+    size_t _first;
+    size_t _count;
+    // Sum of the absolute differences between consecutive samples.
+    int64_t _jitter_total;
+};
+
+}  // namespace ping
+}  // namespace i3d
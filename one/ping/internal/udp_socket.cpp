@@ -1,8 +1,10 @@
 #include <one/ping/internal/udp_socket.h>
 
-#include <array>
+#include <string.h>
+#include <algorithm>
 
-#ifdef I3D_PING_LINUX
+#ifndef I3D_PING_WINDOWS
+    #include <errno.h>
     #include <time.h>
 #endif
 
@@ -28,340 +30,285 @@ I3dPingError shutdown_socket_system() {
     return I3D_PING_ERROR_NONE;
 }
 
-// See: https://en.cppreference.com/w/cpp/language/value_initialization
-// C++11 Value initialization
-UdpSocket::UdpSocket()
-    : _socket(INVALID_SOCKET)
-    , _destination{}
-    , _source{}
-    , _counter(0)
-    , _timestamp_send(0)
-    , _time_milliseconds(0)
-    , _status(Status::uninitialized)
-    , _base_data("Hello Arcus ")  // The base data must have a size greather than 2, since
-                                  // the ping endpoint mirror the reply with the first two
-                                  // byte flipped to '\0'.
-{}
-
-I3dPingError UdpSocket::update() {
-    I3dPingError err = I3D_PING_ERROR_NONE;
-
-    switch (_status) {
-        case Status::uninitialized:
-            return I3D_PING_ERROR_SOCKET_NOT_INITIALIZED;
-        case Status::initialized:
-            err = send_ping();
-            if (err == I3D_PING_ERROR_SOCKET_NOT_READY) {
-                // Retry until the socket is ready. Without returning an error.
-                return I3D_PING_ERROR_NONE;
-            } else if (i3d_ping_is_error(err)) {
-                _status = Status::error;
-                return err;
-            }
-            break;
-        case Status::ping_sent:
-            err = receive_ping();
-            if (err == I3D_PING_ERROR_SOCKET_NOT_READY) {
-                // Retry until the socket is ready. Without returning an error.
-                return I3D_PING_ERROR_NONE;
-            } else if (i3d_ping_is_error(err)) {
-                _status = Status::error;
-                return err;
-            }
-            break;
-        case Status::ping_received:
-        case Status::error:
-            reset();
-            break;
-        default:
-            return I3D_PING_ERROR_SOCKET_UNKNOWN_STATUS;
-    }
+namespace {
 
-    return I3D_PING_ERROR_NONE;
+#if defined(I3D_PING_LINUX) && defined(__linux__)
+    #define I3D_PING_BATCHED_SOCKET_CALLS
+// Datagrams per sendmmsg or recvmmsg call.
+constexpr size_t batch_size = 64;
+#endif
+
+// Whether the last socket call failed only because it would have blocked.
+bool is_would_block_error() {
+#ifdef I3D_PING_WINDOWS
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
 }
 
-I3dPingError UdpSocket::init(const char *ipv4, int port) {
-    if (ipv4 == nullptr) {
-        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+// Errors of a single datagram, rather than of the socket. Windows reports
+// the ICMP port unreachable replies of previous sends this way.
+bool is_datagram_error() {
+#ifdef I3D_PING_WINDOWS
+    const int error = WSAGetLastError();
+    return error == WSAECONNRESET || error == WSAEMSGSIZE;
+#else
+    return errno == EINTR || errno == ECONNREFUSED;
+#endif
+}
+
+#ifdef I3D_PING_BATCHED_SOCKET_CALLS
+// Converts the kernel receive timestamp of a message, on the realtime clock,
+// to the steady clock, given both clocks' current time: the datagram arrived
+// as long before now on either clock. Uses now if the message has no
+// timestamp, or if the realtime clock was visibly stepped in between.
+std::chrono::steady_clock::time_point receive_time(
+    const msghdr &message, const timespec &realtime_now,
+    std::chrono::steady_clock::time_point steady_now) {
+    for (cmsghdr *control = CMSG_FIRSTHDR(&message); control != nullptr;
+         control = CMSG_NXTHDR(const_cast<msghdr *>(&message), control)) {
+        if (control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_TIMESTAMPNS) {
+            continue;
+        }
+
+        timespec timestamp;
+        memcpy(&timestamp, CMSG_DATA(control), sizeof(timestamp));
+        const auto waited =
+            std::chrono::seconds(realtime_now.tv_sec - timestamp.tv_sec) +
+            std::chrono::nanoseconds(realtime_now.tv_nsec - timestamp.tv_nsec);
+        if (waited < std::chrono::nanoseconds::zero() ||
+            std::chrono::seconds(10) < waited) {
+            break;  // Stepped clock.
+        }
+        return steady_now -
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(waited);
     }
+    return steady_now;
+}
+#endif
+
+}  // namespace
 
+UdpSocket::UdpSocket() : _socket(INVALID_SOCKET) {}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+I3dPingError UdpSocket::init() {
     if (is_initialized()) {
         return I3D_PING_ERROR_SOCKET_ALREADY_INITIALIZED;
     }
 
-    _ipv4 = ipv4;
-
 #ifdef I3D_PING_WINDOWS
     _socket = WSASocket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, 0, 0, 0);
-    if (_socket == INVALID_SOCKET) {
-        return I3D_PING_ERROR_SOCKET_CREATION_FAIL;
-    }
-
-    inet_pton(AF_INET, _ipv4.c_str(), &(_destination.sin_addr));
-    _destination.sin_port = htons(port);
-    _destination.sin_family = AF_INET;
 #else
     _socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#endif
     if (_socket == INVALID_SOCKET) {
         return I3D_PING_ERROR_SOCKET_CREATION_FAIL;
     }
 
-    const unsigned int addr = inet_addr(_ipv4.c_str());
-
-    if (addr == INADDR_NONE) {
-        return I3D_PING_ERROR_SOCKET_INVALID_IPV4;
+#ifdef I3D_PING_WINDOWS
+    u_long is_non_blocking = 1;
+    const bool is_set = ioctlsocket(_socket, FIONBIO, &is_non_blocking) == 0;
+#else
+    const int flags = fcntl(_socket, F_GETFL, 0);
+    const bool is_set = flags >= 0 && fcntl(_socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    if (!is_set) {
+        close();
+        return I3D_PING_ERROR_SOCKET_CREATION_FAIL;
     }
 
-    _destination.sin_addr.s_addr = addr;
-    _destination.sin_port = htons(port);
-    _destination.sin_family = AF_INET;
+#ifdef I3D_PING_BATCHED_SOCKET_CALLS
+    // Optional, the receive time is taken after receiving without it.
+    const int is_timestamped = 1;
+    setsockopt(_socket, SOL_SOCKET, SO_TIMESTAMPNS, &is_timestamped,
+               sizeof(is_timestamped));
 #endif
 
-    _status = Status::initialized;
-    return I3D_PING_ERROR_NONE;
-}
-
-I3dPingError UdpSocket::time_milliseconds(int &time_milliseconds) const {
-    if (!is_ping_received()) {
-        return I3D_PING_ERROR_SOCKET_INVALID_TIME;
+    // Bound up front, receiving on an unbound socket fails on Windows.
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = 0;
+    if (::bind(_socket, (sockaddr *)&local, sizeof(local)) != 0) {
+        close();
+        return I3D_PING_ERROR_SOCKET_CREATION_FAIL;
     }
 
-    time_milliseconds = _time_milliseconds;
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError UdpSocket::reset() {
-    switch (_status) {
-        case Status::ping_received:
-        case Status::error:
-            _status = Status::initialized;
-            return I3D_PING_ERROR_NONE;
-        case Status::uninitialized:
-        case Status::initialized:
-        case Status::ping_sent:
-        default:
-            return I3D_PING_ERROR_SOCKET_CANNOT_BE_RESET;
-    }
-}
-
-I3dPingError UdpSocket::send_ping() {
+void UdpSocket::close() {
     if (!is_initialized()) {
-        return I3D_PING_ERROR_SOCKET_NOT_INITIALIZED;
-    }
-
-    bool is_ready = false;
-    auto err = ready_for_send(0, is_ready);
-    if (i3d_ping_is_error(err)) {
-        return err;
+        return;
     }
 
-    if (!is_ready) {
-        return I3D_PING_ERROR_SOCKET_NOT_READY;
-    }
-
-    _counter += 1;
-    _timestamp_send = get_tick_count();
-
-    _data = _base_data + std::to_string(_counter);
-
 #ifdef I3D_PING_WINDOWS
-    // +1 to send the '\0' at the end.
-    const int byte_wrote = ::sendto(_socket, (char *)_data.c_str(), _data.size() + 1, 0,
-                                    (sockaddr *)&_destination, sizeof(_destination));
-    if (byte_wrote == SOCKET_ERROR) {
-        return I3D_PING_ERROR_SOCKET_SEND_FAIL;
-    }
+    closesocket(_socket);
 #else
-    // +1 to send the '\0' at the end.
-    const int byte_wrote = ::sendto(_socket, (char *)_data.c_str(), _data.size() + 1, 0,
-                                    (sockaddr *)&_destination, sizeof(_destination));
-    if (byte_wrote < 0) {
-        return I3D_PING_ERROR_SOCKET_SEND_FAIL;
-    }
+    ::close(_socket);
 #endif
-
-    _status = Status::ping_sent;
-    return I3D_PING_ERROR_NONE;
+    _socket = INVALID_SOCKET;
 }
 
-I3dPingError UdpSocket::receive_ping() {
-    if (!is_ping_sent()) {
-        return I3D_PING_ERROR_SOCKET_PING_NOT_SENT;
-    }
-
-    bool is_ready = false;
+I3dPingError UdpSocket::send(const Datagram *datagrams, size_t count, size_t &sent) {
+    sent = 0;
 
-    auto err = ready_for_read(0, is_ready);
-    if (i3d_ping_is_error(err)) {
-        return err;
+    if (!is_initialized()) {
+        return I3D_PING_ERROR_SOCKET_NOT_INITIALIZED;
     }
 
-    if (!is_ready) {
-        return I3D_PING_ERROR_SOCKET_NOT_READY;
+    if (datagrams == nullptr && count != 0) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
     }
 
-    std::array<char, 1024> buffer = {'\0'};
-    int byte_read = 0;
-
-    // The buffer must be at least bigger than data, to take into acount the trailing
-    // '\0'.
-    if (buffer.size() < _data.size() + 1) {
-        return I3D_PING_ERROR_SOCKET_RECEIVE_BUFFER_TOO_SMALL;
-    }
+#ifdef I3D_PING_BATCHED_SOCKET_CALLS
+    mmsghdr messages[batch_size];
+    iovec vectors[batch_size];
+    while (sent < count) {
+        const size_t batch = std::min(count - sent, batch_size);
+        for (size_t i = 0; i < batch; ++i) {
+            const Datagram &datagram = datagrams[sent + i];
+            vectors[i].iov_base = const_cast<char *>(datagram.data);
+            vectors[i].iov_len = datagram.size;
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_name = const_cast<sockaddr_in *>(&datagram.address);
+            messages[i].msg_hdr.msg_namelen = sizeof(datagram.address);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
 
-#ifdef I3D_PING_WINDOWS
-    int from_length = sizeof(_source);
-    byte_read = recvfrom(_socket, buffer.data(), buffer.size(), 0, (sockaddr *)&_source,
-                         &from_length);
-    if (byte_read == SOCKET_ERROR) {
-        if (WSAGetLastError() == WSAEMSGSIZE) {
-            return I3D_PING_ERROR_SOCKET_RECEIVE_BUFFER_TOO_SMALL;
-        } else {
-            return I3D_PING_ERROR_SOCKET_RECEIVE_ERROR;
+        // Stops at the first failing datagram, whose error is then returned
+        // by the next call.
+        const int result =
+            ::sendmmsg(_socket, messages, static_cast<unsigned int>(batch), 0);
+        if (result < 0) {
+            if (is_would_block_error()) {
+                return I3D_PING_ERROR_NONE;
+            }
+            ++sent;  // Dropped.
+            continue;
         }
+        sent += static_cast<size_t>(result);
     }
 #else
-    unsigned int from_length = sizeof(_source);
-    byte_read = recvfrom(_socket, buffer.data(), buffer.size(), 0, (sockaddr *)&_source,
-                         &from_length);
-    if (byte_read < 0) {
-        return I3D_PING_ERROR_SOCKET_RECEIVE_ERROR;
-    }
-#endif
-    // Taking into acount the trailing '\0'.
-    if (buffer.size() < _data.size() + 1) {
-        return I3D_PING_ERROR_SOCKET_INVALID_REPLY;
-    }
-
-    // The ping endpoint will mirror the sent reply with the first two byte changed to
-    // '\0'.
-    if (buffer[0] != '\0') {
-        return I3D_PING_ERROR_SOCKET_INVALID_REPLY;
-    }
-
-    if (buffer[1] != '\0') {
-        return I3D_PING_ERROR_SOCKET_INVALID_REPLY;
-    }
-
-    // Skipping the first two characters since they are '\0'.
-    for (unsigned int i = 2; i < _data.size(); ++i) {
-        if (buffer[i] != _data[i]) {
-            return I3D_PING_ERROR_SOCKET_INVALID_REPLY;
+    for (; sent < count; ++sent) {
+        const Datagram &datagram = datagrams[sent];
+        const int result =
+            ::sendto(_socket, datagram.data, static_cast<int>(datagram.size), 0,
+                     (const sockaddr *)&datagram.address, sizeof(datagram.address));
+        if (result < 0 && is_would_block_error()) {
+            return I3D_PING_ERROR_NONE;
         }
     }
+#endif
 
-    // Checking the trailing '\0' as it was explicitly sent.
-    if (buffer[_data.size()] != '\0') {
-        return I3D_PING_ERROR_SOCKET_INVALID_REPLY;
-    }
-
-    const unsigned long milleseconds = get_tick_count() - _timestamp_send;
-
-    // Divided by two to take into account the round trip time.
-    _time_milliseconds = milleseconds / 2;
-
-    _status = Status::ping_received;
     return I3D_PING_ERROR_NONE;
 }
 
-I3dPingError UdpSocket::ready_for_read(int timeout, bool &is_ready) {
-    is_ready = false;
+I3dPingError UdpSocket::receive(Datagram *datagrams, size_t capacity, size_t &received) {
+    received = 0;
 
     if (!is_initialized()) {
         return I3D_PING_ERROR_SOCKET_NOT_INITIALIZED;
     }
 
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(_socket, &fds);
-
-    const auto seconds = timeout;
-    const auto microseconds = (timeout - seconds) * 1000000;
-    timeval converted_timeout;
-    converted_timeout.tv_sec = seconds;
-    converted_timeout.tv_usec = microseconds;
+    if (datagrams == nullptr && capacity != 0) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
+    }
 
-    const int result = ::select((int)_socket + 1, &fds, NULL, NULL, &converted_timeout);
-    if (result < 0) return I3D_PING_ERROR_SOCKET_SELECT_FAILED;
-    if (result > 0) is_ready = true;
-    return I3D_PING_ERROR_NONE;
-}
+#ifdef I3D_PING_BATCHED_SOCKET_CALLS
+    mmsghdr messages[batch_size];
+    iovec vectors[batch_size];
+    char controls[batch_size][CMSG_SPACE(sizeof(timespec))];
+    while (received < capacity) {
+        const size_t batch = std::min(capacity - received, batch_size);
+        for (size_t i = 0; i < batch; ++i) {
+            Datagram &datagram = datagrams[received + i];
+            vectors[i].iov_base = datagram.data;
+            vectors[i].iov_len = sizeof(datagram.data);
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_name = &datagram.address;
+            messages[i].msg_hdr.msg_namelen = sizeof(datagram.address);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_control = controls[i];
+            messages[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+        }
 
-I3dPingError UdpSocket::ready_for_send(int timeout, bool &is_ready) {
-    is_ready = false;
+        const int result =
+            ::recvmmsg(_socket, messages, static_cast<unsigned int>(batch), 0, nullptr);
+        if (result < 0) {
+            if (is_would_block_error()) {
+                return I3D_PING_ERROR_NONE;
+            }
+            if (is_datagram_error()) {
+                continue;
+            }
+            return I3D_PING_ERROR_SOCKET_RECEIVE_ERROR;
+        }
 
-    if (!is_initialized()) {
-        return I3D_PING_ERROR_SOCKET_NOT_INITIALIZED;
+        const auto steady_now = std::chrono::steady_clock::now();
+        timespec realtime_now;
+        clock_gettime(CLOCK_REALTIME, &realtime_now);
+        for (int i = 0; i < result; ++i) {
+            Datagram &datagram = datagrams[received + i];
+            const bool is_truncated = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+            datagram.size = is_truncated ? 0 : messages[i].msg_len;
+            datagram.time = receive_time(messages[i].msg_hdr, realtime_now, steady_now);
+        }
+        received += static_cast<size_t>(result);
+        if (static_cast<size_t>(result) < batch) {
+            return I3D_PING_ERROR_NONE;
+        }
     }
+#else
+    while (received < capacity) {
+        Datagram &datagram = datagrams[received];
+    #ifdef I3D_PING_WINDOWS
+        int from_length = sizeof(datagram.address);
+    #else
+        socklen_t from_length = sizeof(datagram.address);
+    #endif
+        const int result =
+            ::recvfrom(_socket, datagram.data, static_cast<int>(sizeof(datagram.data)), 0,
+                       (sockaddr *)&datagram.address, &from_length);
+        if (result < 0) {
+            if (is_would_block_error()) {
+                return I3D_PING_ERROR_NONE;
+            }
+            if (is_datagram_error()) {
+                continue;
+            }
+            return I3D_PING_ERROR_SOCKET_RECEIVE_ERROR;
+        }
 
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(_socket, &fds);
-
-    const auto seconds = timeout;
-    const auto microseconds = (timeout - seconds) * 1000000;
-    timeval converted_timeout;
-    converted_timeout.tv_sec = seconds;
-    converted_timeout.tv_usec = microseconds;
+        datagram.size = static_cast<size_t>(result);
+        datagram.time = std::chrono::steady_clock::now();
+        ++received;
+    }
+#endif
 
-    const int result = ::select((int)_socket + 1, NULL, &fds, NULL, &converted_timeout);
-    if (result < 0) return I3D_PING_ERROR_SOCKET_SELECT_FAILED;
-    if (result > 0) is_ready = true;
     return I3D_PING_ERROR_NONE;
 }
 
-bool UdpSocket::is_initialized() const {
-    switch (_status) {
-        case Status::uninitialized:
-            return false;
-            ;
-        case Status::initialized:
-        case Status::ping_sent:
-        case Status::ping_received:
-        case Status::error:
-        default:
-            return true;
+I3dPingError UdpSocket::address(const char *ipv4, int port, sockaddr_in &address) {
+    if (ipv4 == nullptr) {
+        return I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR;
     }
-}
 
-bool UdpSocket::is_ping_sent() const {
-    switch (_status) {
-        case Status::ping_sent:
-            return true;
-            ;
-        case Status::uninitialized:
-        case Status::initialized:
-        case Status::ping_received:
-        case Status::error:
-        default:
-            return false;
-    }
-}
-
-bool UdpSocket::is_ping_received() const {
-    switch (_status) {
-        case Status::ping_received:
-            return true;
-        case Status::uninitialized:
-        case Status::initialized:
-        case Status::ping_sent:
-        case Status::error:
-        default:
-            return false;
+    address = sockaddr_in{};
+    if (inet_pton(AF_INET, ipv4, &address.sin_addr) != 1) {
+        return I3D_PING_ERROR_SOCKET_INVALID_IPV4;
     }
-}
 
-unsigned long UdpSocket::get_tick_count() const {
-    unsigned long count = 0;
-#ifdef I3D_PING_WINDOWS
-    count = GetTickCount();
-#else
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    count = ts.tv_nsec / 1000000;
-    count += ts.tv_sec * 1000;
-#endif
-    return count;
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    return I3D_PING_ERROR_NONE;
 }
 
 }  // namespace ping
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stddef.h>
+#include <chrono>
+
 #include <one/ping/c_platform.h>
 #include <one/ping/types.h>
 #include <one/ping/error.h>
@@ -23,6 +26,7 @@ const int INVALID_SOCKET = -1;
     #include <fcntl.h>
     #include <netinet/in.h>
     #include <sys/ioctl.h>
+    #include <sys/socket.h>
     #include <unistd.h>
 
     #include <netinet/tcp.h>
@@ -45,59 +49,51 @@ I3dPingError init_socket_system();
 // calls decrement counters matching the number of times init was called.
 I3dPingError shutdown_socket_system();
 
+// A UDP datagram, for the batched sends and receives of UdpSocket.
+struct Datagram {
+    // Large enough for the pings and their replies.
+    static constexpr size_t max_size = 128;
+
+    sockaddr_in address;  // The destination when sending, the source when received.
+    size_t size;          // 0 for received datagrams larger than max_size.
+    char data[max_size];
+    // When a received datagram arrived. The kernel's receive timestamp where
+    // available, so that it excludes the time spent waiting for the update.
+    std::chrono::steady_clock::time_point time;
+};
+
+// A non-blocking UDP socket, shared by all the pinged sites so that their
+// number is not limited by file descriptors. Sends and receives are batched,
+// with a single system call per batch on Linux.
 class UdpSocket final {
 public:
     UdpSocket();
-    UdpSocket(const UdpSocket &) = default;
+    UdpSocket(const UdpSocket &) = delete;
     UdpSocket &operator=(const UdpSocket &) = delete;
-    ~UdpSocket() = default;
-
-    const String &ipv4() const {
-        return _ipv4;
-    }
-
-    I3dPingError update();
-
-    I3dPingError init(const char *ipv4, int port);
-
-    enum class Status { uninitialized, initialized, ping_sent, ping_received, error };
+    ~UdpSocket();
 
-    I3dPingError time_milliseconds(int &time_milliseconds) const;
+    I3dPingError init();
+    void close();
 
-    Status status() const {
-        return _status;
+    bool is_initialized() const {
+        return _socket != INVALID_SOCKET;
     }
 
-    I3dPingError reset();
+    // Sends the datagrams in order until the socket's send buffer is full.
+    // Sets sent to the number of datagrams processed, the remaining ones can
+    // be sent later. A datagram that fails to send, e.g. to an unreachable
+    // network, is dropped like a datagram lost on the way, so that one site
+    // doesn't hold up the others.
+    I3dPingError send(const Datagram *datagrams, size_t count, size_t &sent);
 
-private:
-    void init_packet(int seq_no);
-    unsigned short checksum(unsigned short *buffer, int size) const;
-    I3dPingError send_ping();
-    I3dPingError receive_ping();
-
-    I3dPingError ready_for_read(int timeout, bool &is_ready);
-    I3dPingError ready_for_send(int timeout, bool &is_ready);
-
-    bool is_initialized() const;
-    bool is_ping_sent() const;
-    bool is_ping_received() const;
-
-    unsigned long get_tick_count() const;
+    // Receives up to capacity datagrams without waiting. Sets received to the
+    // number received, less than capacity once no more are pending.
+    I3dPingError receive(Datagram *datagrams, size_t capacity, size_t &received);
 
-    String _ipv4;
+    static I3dPingError address(const char *ipv4, int port, sockaddr_in &address);
 
+private:
     SOCKET _socket;
-    sockaddr_in _destination;
-    sockaddr_in _source;
-
-    unsigned long _counter;
-    unsigned long _timestamp_send;
-    int _time_milliseconds;
-    Status _status;
-
-    const std::string _base_data;
-    std::string _data;
 };
 
 }  // namespace ping
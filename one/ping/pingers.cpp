@@ -1,16 +1,54 @@
 #include <one/ping/pingers.h>
 
 #include <one/ping/allocator.h>
-#include <one/ping/internal/udp_socket.h>
+
+#include <algorithm>
+#include <thread>
 
 //#define ONE_ARCUS_CLIENT_LOGGING
 
 namespace i3d {
 namespace ping {
 
+namespace {
+// Datagrams received per receive call. More are received by further calls.
+constexpr size_t receive_batch_size = 64;
+
+uint64_t destination_key(const sockaddr_in &address) {
+    return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+bool is_key_less(const std::pair<uint64_t, size_t> &a,
+                 const std::pair<uint64_t, size_t> &b) {
+    return a.first < b.first;
+}
+
+void site_statistics(const Pinger &pinger, Pingers::Statistics &statistics) {
+    statistics = Pingers::Statistics{-1, -1.0, -1, -1, -1.0, -1, -1, -1.0, 0, 0, 0};
+
+    // Each statistic keeps -1 until it is available.
+    pinger.last_time_us(statistics.last_time);
+    pinger.average_time_us(statistics.average_time);
+    pinger.min_time_us(statistics.min_time);
+    pinger.max_time_us(statistics.max_time);
+    pinger.median_time_us(statistics.median_time);
+    pinger.percentile_time_us(90.0, statistics.p90_time);
+    pinger.percentile_time_us(99.0, statistics.p99_time);
+    pinger.jitter_us(statistics.jitter);
+    pinger.ping_response_count(statistics.ping_response_count);
+    pinger.ping_sent_count(statistics.ping_sent_count);
+    pinger.ping_lost_count(statistics.ping_lost_count);
+}
+}  // namespace
+
 // See: https://en.cppreference.com/w/cpp/language/value_initialization
 // C++11 Value initialization
-Pingers::Pingers() : _status(Status::uninitialized) {}
+Pingers::Pingers()
+    : _ping_interval_ms(Pinger::default_interval_ms)
+    , _history_size(TimeWindow::default_size)
+    , _snapshot_front(0)
+    , _snapshot_readers{}
+    , _status(Status::uninitialized) {}
 
 Pingers::~Pingers() {
     shutdown();
@@ -32,17 +70,36 @@ I3dPingError Pingers::init(const IpList &ip_list) {
 
     const auto &ips = ip_list.ips();
 
+    _socket.close();
+    err = _socket.init();
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
     _pingers.clear();
     _pingers.resize(ips.size());
-
-    err = I3D_PING_ERROR_NONE;
+    _destinations.clear();
 
     for (size_t i = 0; i < ips.size(); ++i) {
         err = _pingers[i].init(ips[i].c_str());
         if (i3d_ping_is_error(err)) {
             return err;
         }
+        _pingers[i].set_interval(std::chrono::milliseconds(_ping_interval_ms));
+        err = _pingers[i].set_history_size(_history_size);
+        if (i3d_ping_is_error(err)) {
+            return err;
+        }
+
+        _destinations.emplace_back(destination_key(_pingers[i].destination()), i);
     }
+    std::sort(_destinations.begin(), _destinations.end(), is_key_less);
+
+    // Sized once, for a send to all the pingers.
+    _datagrams.resize(std::max(ips.size(), receive_batch_size));
+    _datagram_pingers.resize(ips.size());
+
+    resize_snapshots();
 
     _status = Status::initialized;
     return I3D_PING_ERROR_NONE;
@@ -50,8 +107,15 @@ I3dPingError Pingers::init(const IpList &ip_list) {
 
 void Pingers::shutdown() {
     const std::lock_guard<std::mutex> lock(_ping);
+    _socket.close();
     shutdown_socket_system();
     _pingers.clear();
+    _destinations.clear();
+    _datagrams.clear();
+    _datagram_pingers.clear();
+    // Readers copying a snapshot are waited for, later ones get no sites.
+    resize_snapshots();
+    _status = Status::uninitialized;
 }
 
 I3dPingError Pingers::update() {
@@ -61,10 +125,34 @@ I3dPingError Pingers::update() {
         return I3D_PING_ERROR_PINGERS_NOT_INITIALIZED;
     }
 
-    auto err = I3D_PING_ERROR_NONE;
+    auto err = receive_replies();
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    err = send_pings();
+    publish_snapshot();
+    return err;
+}
+
+void Pingers::set_ping_interval(unsigned int interval_ms) {
+    const std::lock_guard<std::mutex> lock(_ping);
+    _ping_interval_ms = interval_ms;
+    for (auto &pinger : _pingers) {
+        pinger.set_interval(std::chrono::milliseconds(interval_ms));
+    }
+}
 
+I3dPingError Pingers::set_history_size(unsigned int size) {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (size == 0 || TimeWindow::max_size < size) {
+        return I3D_PING_ERROR_PINGER_INVALID_HISTORY_SIZE;
+    }
+
+    _history_size = size;
     for (auto &pinger : _pingers) {
-        err = pinger.update();
+        auto err = pinger.set_history_size(size);
         if (i3d_ping_is_error(err)) {
             return err;
         }
@@ -73,6 +161,105 @@ I3dPingError Pingers::update() {
     return I3D_PING_ERROR_NONE;
 }
 
+I3dPingError Pingers::receive_replies() {
+    const size_t capacity = std::min(_datagrams.size(), receive_batch_size);
+    size_t received = 0;
+    do {
+        auto err = _socket.receive(_datagrams.data(), capacity, received);
+        if (i3d_ping_is_error(err)) {
+            return err;
+        }
+
+        // Several sites may share an address, the data tells which ping it
+        // replies to.
+        for (size_t i = 0; i < received; ++i) {
+            const auto &datagram = _datagrams[i];
+            const auto key = std::make_pair(destination_key(datagram.address), size_t(0));
+            const auto range = std::equal_range(_destinations.cbegin(),
+                                                _destinations.cend(), key, is_key_less);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (_pingers[it->second].receive(datagram)) {
+                    break;
+                }
+            }
+        }
+    } while (received == capacity);
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::send_pings() {
+    size_t count = 0;
+    for (size_t i = 0; i < _pingers.size(); ++i) {
+        if (_pingers[i].prepare_ping(_datagrams[count])) {
+            _datagram_pingers[count] = i;
+            ++count;
+        }
+    }
+
+    // Pings not sent because the send buffer is full are prepared again by
+    // the next update.
+    size_t sent = 0;
+    auto err = _socket.send(_datagrams.data(), count, sent);
+    for (size_t i = 0; i < sent; ++i) {
+        _pingers[_datagram_pingers[i]].ping_sent();
+    }
+
+    return err;
+}
+
+void Pingers::publish_snapshot() {
+    // Only update writes, under the lock. A reader may still be on the back
+    // buffer if it acquired it before the last publish, in which case the
+    // next update publishes.
+    const size_t back = 1 - _snapshot_front.load();
+    if (_snapshot_readers[back].load() != 0) {
+        return;
+    }
+
+    write_snapshot(back);
+    _snapshot_front.store(back);
+}
+
+void Pingers::write_snapshot(size_t buffer) {
+    auto &snapshot = _snapshots[buffer];
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        site_statistics(_pingers[i], snapshot[i]);
+    }
+}
+
+void Pingers::resize_snapshots() {
+    for (int i = 0; i < 2; ++i) {
+        // The readers of the back buffer acquired it before the last publish,
+        // and new readers don't stay on it.
+        const size_t back = 1 - _snapshot_front.load();
+        while (_snapshot_readers[back].load() != 0) {
+            std::this_thread::yield();
+        }
+
+        _snapshots[back].resize(_pingers.size());
+        write_snapshot(back);
+        _snapshot_front.store(back);
+    }
+}
+
+size_t Pingers::acquire_snapshot() const {
+    // The buffer is read only if still the front one once counted, update
+    // doesn't write a buffer with readers.
+    for (;;) {
+        const size_t buffer = _snapshot_front.load();
+        _snapshot_readers[buffer].fetch_add(1);
+        if (_snapshot_front.load() == buffer) {
+            return buffer;
+        }
+        _snapshot_readers[buffer].fetch_sub(1);
+    }
+}
+
+void Pingers::release_snapshot(size_t buffer) const {
+    _snapshot_readers[buffer].fetch_sub(1);
+}
+
 String Pingers::status_to_string(Status status) {
     switch (status) {
         case Status::uninitialized:
@@ -164,6 +351,112 @@ I3dPingError Pingers::median_time(unsigned int pos, double &duration_ms) const {
     return I3D_PING_ERROR_NONE;
 }
 
+I3dPingError Pingers::last_time_us(unsigned int pos, int64_t &duration_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].last_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::average_time_us(unsigned int pos, double &duration_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].average_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::min_time_us(unsigned int pos, int64_t &duration_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].min_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::max_time_us(unsigned int pos, int64_t &duration_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].max_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::median_time_us(unsigned int pos, double &duration_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].median_time_us(duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::percentile_time_us(unsigned int pos, double percentile,
+                                         int64_t &duration_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].percentile_time_us(percentile, duration_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::jitter_us(unsigned int pos, double &jitter_us) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].jitter_us(jitter_us);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
 I3dPingError Pingers::ping_response_count(unsigned int pos,
                                           unsigned int &response_count) const {
     const std::lock_guard<std::mutex> lock(_ping);
@@ -180,6 +473,36 @@ I3dPingError Pingers::ping_response_count(unsigned int pos,
     return I3D_PING_ERROR_NONE;
 }
 
+I3dPingError Pingers::ping_sent_count(unsigned int pos, unsigned int &sent_count) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].ping_sent_count(sent_count);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
+I3dPingError Pingers::ping_lost_count(unsigned int pos, unsigned int &lost_count) const {
+    const std::lock_guard<std::mutex> lock(_ping);
+
+    if (_pingers.size() <= pos) {
+        return I3D_PING_ERROR_PINGERS_POS_IS_OUT_OF_RANGE;
+    }
+
+    auto err = _pingers[pos].ping_lost_count(lost_count);
+    if (i3d_ping_is_error(err)) {
+        return err;
+    }
+
+    return I3D_PING_ERROR_NONE;
+}
+
 I3dPingError Pingers::at_least_one_site_has_been_pinged(bool &result) const {
     const std::lock_guard<std::mutex> lock(_ping);
 
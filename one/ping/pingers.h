@@ -1,9 +1,14 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
 #include <mutex>
+#include <utility>
 
 #include <one/ping/error.h>
 #include <one/ping/internal/pinger.h>
+#include <one/ping/internal/udp_socket.h>
 #include <one/ping/ip_list.h>
 #include <one/ping/logger.h>
 #include <one/ping/types.h>
@@ -11,7 +16,8 @@
 namespace i3d {
 namespace ping {
 
-// The i3D Ping Client is used to get the i3D ping latency.
+// The i3D Ping Client is used to get the i3D ping latency. All the sites are
+// pinged through a single socket.
 class Pingers final {
 public:
     Pingers();
@@ -25,6 +31,14 @@ public:
     void shutdown();
     I3dPingError update();
 
+    // Minimum time between two pings sent to a site. Several pings can be in
+    // flight for each site, see Pinger.
+    void set_ping_interval(unsigned int interval_ms);
+
+    // Number of the most recent times of a site the median, percentiles and
+    // jitter are computed over, see TimeWindow.
+    I3dPingError set_history_size(unsigned int size);
+
     size_t size() const {
         return _pingers.size();
     }
@@ -39,22 +53,93 @@ public:
     I3dPingError min_time(unsigned int pos, int &duration_ms) const;
     I3dPingError max_time(unsigned int pos, int &duration_ms) const;
     I3dPingError median_time(unsigned int pos, double &duration_ms) const;
+    I3dPingError last_time_us(unsigned int pos, int64_t &duration_us) const;
+    I3dPingError average_time_us(unsigned int pos, double &duration_us) const;
+    I3dPingError min_time_us(unsigned int pos, int64_t &duration_us) const;
+    I3dPingError max_time_us(unsigned int pos, int64_t &duration_us) const;
+    I3dPingError median_time_us(unsigned int pos, double &duration_us) const;
+    I3dPingError percentile_time_us(unsigned int pos, double percentile,
+                                    int64_t &duration_us) const;
+    I3dPingError jitter_us(unsigned int pos, double &jitter_us) const;
     I3dPingError ping_response_count(unsigned int pos,
                                      unsigned int &response_count) const;
+    I3dPingError ping_sent_count(unsigned int pos, unsigned int &sent_count) const;
+    I3dPingError ping_lost_count(unsigned int pos, unsigned int &lost_count) const;
 
     I3dPingError at_least_one_site_has_been_pinged(bool &result) const;
     I3dPingError all_sites_have_been_pinged(bool &result) const;
 
+    // The statistics of a site, times in microseconds. A time or jitter that
+    // is not available yet is -1.
+    struct Statistics {
+        int64_t last_time;
+        double average_time;
+        int64_t min_time;
+        int64_t max_time;
+        double median_time;
+        int64_t p90_time;
+        int64_t p99_time;
+        double jitter;
+        unsigned int ping_response_count;
+        unsigned int ping_sent_count;
+        unsigned int ping_lost_count;
+    };
+
+    // Calls visit(pos, const Statistics &) for each site of the statistics
+    // published by the last update, in the order of the ip list, then returns
+    // the number of sites. Doesn't lock the pingers or allocate, visit must not
+    // call back into the pingers. After a shutdown, which waits for the
+    // visits, there are no sites.
+    template <typename Visitor>
+    size_t visit_snapshot(Visitor visit) const {
+        const size_t buffer = acquire_snapshot();
+        const auto &statistics = _snapshots[buffer];
+        for (size_t i = 0; i < statistics.size(); ++i) {
+            visit(i, statistics[i]);
+        }
+        const size_t count = statistics.size();
+        release_snapshot(buffer);
+        return count;
+    }
+
 private:
-    I3dPingError update_pings();
+    I3dPingError receive_replies();
+    I3dPingError send_pings();
 
     I3dPingError number_sites_pigned(unsigned int &count) const;
 
+    // The snapshots are double-buffered: update writes the statistics to the
+    // back buffer and publishes it as the front one. Readers count themselves
+    // on the buffer they read, and update skips publishing while the back
+    // buffer is still read.
+    void publish_snapshot();
+    void write_snapshot(size_t buffer);
+    // Resizes both buffers to the number of pingers, each once it is the back
+    // buffer without readers, and publishes it. Waits for the readers.
+    void resize_snapshots();
+    size_t acquire_snapshot() const;
+    void release_snapshot(size_t buffer) const;
+
     mutable std::mutex _ping;
 
     Logger _logger;
 
+    UdpSocket _socket;
     Vector<Pinger> _pingers;
+    // The pingers' destinations, as keys, with their index, sorted to find the
+    // pinger of a reply.
+    Vector<std::pair<uint64_t, size_t>> _destinations;
+    // The datagrams of a batch of receives or sends, and the pinger of each sent
+    // datagram.
+    Vector<Datagram> _datagrams;
+    Vector<size_t> _datagram_pingers;
+    unsigned int _ping_interval_ms;
+    unsigned int _history_size;
+
+    Vector<Statistics> _snapshots[2];
+    std::atomic<size_t> _snapshot_front;
+    mutable std::atomic<unsigned int> _snapshot_readers[2];
+
     Status _status;
 };
 
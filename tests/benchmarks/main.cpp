@@ -0,0 +1,328 @@
+// Throughput benchmarks of the Arcus message pipeline: the codec, the JSON
+// payload conversion and the Connection over a loopback socket pair.
+//
+// Usage: benchmarks [--min-time-ms <ms>] [filter...]
+//
+// Each case whose name contains one of the filters, or every case if there is
+// no filter, is run repeatedly for at least the minimum time after a warm up.
+// The messages and bytes per second and the SDK allocations per message are
+// printed, the allocations being those made through one::allocator.
+
+#include <one/arcus/allocator.h>
+#include <one/arcus/array.h>
+#include <one/arcus/error.h>
+#include <one/arcus/internal/codec.h>
+#include <one/arcus/internal/connection.h>
+#include <one/arcus/internal/socket.h>
+#include <one/arcus/message.h>
+#include <one/arcus/object.h>
+#include <one/arcus/opcode.h>
+#include <one/arcus/types.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace i3d::one;
+
+namespace {
+
+//---------------------
+// Allocation counting.
+
+std::atomic<size_t> _allocations(0);
+
+void count_allocations() {
+    allocator::set_alloc([](size_t bytes) -> void * {
+        ++_allocations;
+        return ::malloc(bytes);
+    });
+    allocator::set_free([](void *p) { ::free(p); });
+    allocator::set_realloc([](void *p, size_t bytes) -> void * {
+        ++_allocations;
+        return ::realloc(p, bytes);
+    });
+}
+
+//---------
+// Runner.
+
+// The work done by one call of a benchmark operation.
+struct Work {
+    size_t messages;
+    size_t bytes;
+};
+
+struct Options {
+    std::chrono::milliseconds min_time;
+    std::vector<std::string> filters;
+};
+
+bool is_selected(const Options &options, const char *name) {
+    if (options.filters.empty()) return true;
+    for (const auto &filter : options.filters) {
+        if (std::strstr(name, filter.c_str()) != nullptr) return true;
+    }
+    return false;
+}
+
+// Runs the operation for a tenth of the minimum time to warm up caches and
+// reach the steady state memory use, then measures it for at least the
+// minimum time.
+void run(const Options &options, const char *name, std::function<Work()> operation) {
+    if (!is_selected(options, name)) return;
+
+    using clock = std::chrono::steady_clock;
+    const auto warm_up_end = clock::now() + options.min_time / 10;
+    do {
+        operation();
+    } while (clock::now() < warm_up_end);
+
+    Work total{0, 0};
+    _allocations = 0;
+    const auto start = clock::now();
+    const auto end = start + options.min_time;
+    auto now = start;
+    do {
+        const Work work = operation();
+        total.messages += work.messages;
+        total.bytes += work.bytes;
+        now = clock::now();
+    } while (now < end);
+    const size_t allocations = _allocations;
+
+    const double seconds = std::chrono::duration<double>(now - start).count();
+    printf("%-44s %12.0f msg/s %10.2f MB/s %8.2f allocs/msg\n", name,
+           total.messages / seconds, total.bytes / seconds / (1024.0 * 1024.0),
+           static_cast<double>(allocations) / total.messages);
+}
+
+void check(OneError err, const char *what) {
+    if (is_error(err)) {
+        fprintf(stderr, "%s failed: %s\n", what, error_text(err));
+        exit(1);
+    }
+}
+
+//-----------
+// Payloads.
+
+// Messages with payloads of the sizes seen in production: the periodic live
+// state, and metadata from a few to hundreds of key value pairs.
+struct Sample {
+    const char *name;
+    Message message;
+};
+
+void prepare_metadata(size_t pairs, Message &message) {
+    Array array;
+    for (size_t i = 0; i < pairs; ++i) {
+        Object pair;
+        const auto index = std::to_string(i);
+        pair.set_val_string("key", ("key_" + index).c_str());
+        pair.set_val_string("value", ("value of the key number " + index).c_str());
+        array.push_back_object(pair);
+    }
+    check(messages::prepare_metadata(array, message), "prepare_metadata");
+}
+
+std::vector<Sample> samples() {
+    std::vector<Sample> samples(4);
+
+    samples[0].name = "live_state";
+    Object additional_data;
+    additional_data.set_val_string("region", "eu-west");
+    additional_data.set_val_int("round", 3);
+    additional_data.set_val_bool("ranked", true);
+    check(messages::prepare_live_state(12, 64, "My Server", "de_dust2", "competitive",
+                                       "1.2.3", &additional_data, samples[0].message),
+          "prepare_live_state");
+
+    samples[1].name = "metadata_4";
+    prepare_metadata(4, samples[1].message);
+    samples[2].name = "metadata_64";
+    prepare_metadata(64, samples[2].message);
+    samples[3].name = "metadata_1024";
+    prepare_metadata(1024, samples[3].message);
+
+    return samples;
+}
+
+const char *encoding_name(codec::PayloadEncoding encoding) {
+    return encoding == codec::PayloadEncoding::json ? "json" : "binary";
+}
+
+//--------------
+// Codec cases.
+
+void run_codec(const Options &options, const Sample &sample,
+               codec::PayloadEncoding encoding) {
+    std::vector<char> data(codec::header_size() + codec::payload_max_size());
+    size_t length = 0;
+    check(codec::message_to_data(1, sample.message, data.data(), data.size(), length,
+                                 encoding),
+          "message_to_data");
+
+    String name = String("codec::message_to_data ") + encoding_name(encoding) + " " +
+                  sample.name;
+    run(options, name.c_str(), [&]() {
+        size_t written = 0;
+        codec::message_to_data(1, sample.message, data.data(), data.size(), written,
+                               encoding);
+        return Work{1, written};
+    });
+
+    name = String("codec::data_to_message ") + encoding_name(encoding) + " " +
+           sample.name;
+    Message message;
+    run(options, name.c_str(), [&]() {
+        codec::Header header{};
+        size_t read = 0;
+        codec::data_to_message(data.data(), length, read, header, message);
+        return Work{1, read};
+    });
+}
+
+void run_payload(const Options &options, const Sample &sample) {
+    const String json = sample.message.payload().to_json();
+
+    String name = String("Payload::to_json ") + sample.name;
+    run(options, name.c_str(), [&]() {
+        const String result = sample.message.payload().to_json();
+        return Work{1, result.size()};
+    });
+
+    name = String("Payload::from_json ") + sample.name;
+    Payload payload;
+    run(options, name.c_str(), [&]() {
+        payload.from_json({json.c_str(), json.size()});
+        return Work{1, json.size()};
+    });
+}
+
+//-------------------
+// Connection cases.
+
+constexpr size_t connection_batch = 32;
+
+// A handshaked pair of connections over loopback sockets.
+class Loopback final {
+public:
+    Loopback(codec::PayloadEncoding encoding)
+        : _sender(connection_batch, connection_batch)
+        , _receiver(connection_batch, connection_batch) {
+        const bool is_binary = encoding == codec::PayloadEncoding::binary;
+        _sender.set_binary_payloads_supported(is_binary);
+        _receiver.set_binary_payloads_supported(is_binary);
+
+        check(_listener.init(), "init");
+        check(_listener.bind(0), "bind");
+        String ip;
+        unsigned int port = 0;
+        check(_listener.address(ip, port), "address");
+        check(_listener.listen(1), "listen");
+        check(_out.init(), "init");
+        check(_out.connect("127.0.0.1", port), "connect");
+        bool is_ready = false;
+        check(_listener.ready_for_read(1.f, is_ready), "ready_for_read");
+        check(_listener.accept(_in, ip, port), "accept");
+
+        _sender.init(_in);
+        _receiver.init(_out);
+        check(_sender.initiate_handshake(), "initiate_handshake");
+        const auto timeout =
+            std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (_sender.status() != Connection::Status::ready ||
+               _receiver.status() != Connection::Status::ready) {
+            check(_sender.update(), "update");
+            check(_receiver.update(), "update");
+            if (timeout < std::chrono::steady_clock::now()) {
+                fprintf(stderr, "loopback handshake timed out\n");
+                exit(1);
+            }
+        }
+    }
+
+    // Sends a batch of copies of the message, returning once all are received.
+    void transfer(const Message &message) {
+        for (size_t i = 0; i < connection_batch; ++i) {
+            check(_sender.add_outgoing(message), "add_outgoing");
+        }
+
+        size_t received = 0;
+        while (received < connection_batch) {
+            check(_sender.update(), "update");
+            check(_receiver.update(), "update");
+            while (!is_error(_receiver.pop_incoming(_received))) {
+                ++received;
+            }
+        }
+    }
+
+private:
+    Socket _listener;
+    Socket _in;
+    Socket _out;
+    Connection _sender;
+    Connection _receiver;
+    Message _received;
+};
+
+void run_connection(const Options &options, const Sample &sample,
+                    codec::PayloadEncoding encoding) {
+    const String name = String("Connection::update ") + encoding_name(encoding) + " " +
+                        sample.name;
+    if (!is_selected(options, name.c_str())) return;
+
+    std::vector<char> data(codec::header_size() + codec::payload_max_size());
+    size_t length = 0;
+    check(codec::message_to_data(1, sample.message, data.data(), data.size(), length,
+                                 encoding),
+          "message_to_data");
+
+    Loopback loopback(encoding);
+    run(options, name.c_str(), [&]() {
+        loopback.transfer(sample.message);
+        return Work{connection_batch, connection_batch * length};
+    });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options{std::chrono::milliseconds(1000), {}};
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            options.min_time = std::chrono::milliseconds(atoi(argv[++i]));
+        } else {
+            options.filters.push_back(argv[i]);
+        }
+    }
+
+    count_allocations();
+    check(init_socket_system(), "init_socket_system");
+
+    const codec::PayloadEncoding encodings[] = {codec::PayloadEncoding::json,
+                                                codec::PayloadEncoding::binary};
+    {
+        const auto all = samples();
+        for (const auto &sample : all) {
+            for (auto encoding : encodings) {
+                run_codec(options, sample, encoding);
+            }
+            run_payload(options, sample);
+            for (auto encoding : encodings) {
+                run_connection(options, sample, encoding);
+            }
+        }
+    }
+
+    shutdown_socket_system();
+    allocator::reset_overrides();
+    return 0;
+}
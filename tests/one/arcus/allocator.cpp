@@ -1,8 +1,14 @@
 #include <catch.hpp>
 #include <one/arcus/allocator.h>
+#include <one/arcus/array.h>
+#include <one/arcus/c_api.h>
+#include <one/arcus/internal/codec.h>
 #include <one/arcus/c_platform.h>
+#include <one/arcus/message.h>
 #include <one/arcus/types.h>
 
+#include <array>
+
 using namespace i3d::one;
 
 namespace {
@@ -111,6 +117,128 @@ TEST_CASE("allocator basics", "[arcus]") {
     }
 }
 
+TEST_CASE("json allocations", "[arcus]") {
+    ScopedAllocationSetter setter;
+    size_t realloc_count = 0;
+    allocator::set_realloc([&](void *, size_t) -> void * {
+        realloc_count++;
+        return nullptr;
+    });
+    const size_t alloc_count = _alloc_count;
+    const size_t free_count = _free_count;
+
+    // All JSON memory, including growing buffers, goes through alloc and free.
+    {
+        Array array;
+        for (int i = 0; i < 100; ++i) {
+            array.push_back_string("value");
+        }
+        Payload payload;
+        REQUIRE(!is_error(payload.set_val_array("data", array)));
+        const String json = payload.to_json();
+        Payload parsed;
+        REQUIRE(!is_error(parsed.from_json({json.c_str(), json.size()})));
+        REQUIRE(parsed.get() == payload.get());
+    }
+    REQUIRE(_alloc_count > alloc_count);
+    REQUIRE(_alloc_count - alloc_count == _free_count - free_count);
+    REQUIRE(realloc_count == 0);
+}
+
+TEST_CASE("allocator instrumentation", "[arcus]") {
+    // Must be enabled while no memory from the allocator is alive.
+    struct ScopedInstrumentation {
+        ScopedInstrumentation() {
+            allocator::set_instrumentation(true);
+            allocator::reset_stats();
+        }
+        ~ScopedInstrumentation() {
+            allocator::set_instrumentation(false);
+        }
+    } instrumentation;
+    const auto stats = [](allocator::Subsystem subsystem) {
+        return allocator::stats(subsystem);
+    };
+
+    // Allocations are attributed to the innermost scope.
+    void *other = allocator::alloc(8);
+    void *codec = nullptr;
+    void *connection = nullptr;
+    {
+        allocator::ScopedSubsystem outer(allocator::Subsystem::codec);
+        codec = allocator::alloc(16);
+        {
+            allocator::ScopedSubsystem inner(allocator::Subsystem::connection);
+            connection = allocator::alloc(32);
+        }
+        codec = allocator::realloc(codec, 64);
+    }
+    REQUIRE(stats(allocator::Subsystem::other).allocations == 1);
+    REQUIRE(stats(allocator::Subsystem::other).bytes == 8);
+    REQUIRE(stats(allocator::Subsystem::codec).allocations == 2);
+    REQUIRE(stats(allocator::Subsystem::codec).frees == 1);
+    REQUIRE(stats(allocator::Subsystem::codec).allocated_bytes == 80);
+    REQUIRE(stats(allocator::Subsystem::codec).bytes == 64);
+    REQUIRE(stats(allocator::Subsystem::codec).peak_bytes == 64);
+    REQUIRE(stats(allocator::Subsystem::connection).bytes == 32);
+    REQUIRE(stats(allocator::Subsystem::all).allocations == 4);
+    REQUIRE(stats(allocator::Subsystem::all).bytes == 104);
+    REQUIRE(stats(allocator::Subsystem::all).peak_bytes == 104);
+
+    // Frees are attributed to the subsystem of the allocation.
+    allocator::free(connection);
+    allocator::free(codec);
+    allocator::free(other);
+    REQUIRE(stats(allocator::Subsystem::connection).frees == 1);
+    REQUIRE(stats(allocator::Subsystem::connection).bytes == 0);
+    REQUIRE(stats(allocator::Subsystem::codec).bytes == 0);
+    REQUIRE(stats(allocator::Subsystem::all).bytes == 0);
+    REQUIRE(stats(allocator::Subsystem::all).peak_bytes == 104);
+
+    allocator::reset_stats();
+    REQUIRE(stats(allocator::Subsystem::all).allocations == 0);
+    REQUIRE(stats(allocator::Subsystem::all).peak_bytes == 0);
+
+    // Decoding into a reused message does not allocate in a steady state.
+    {
+        Message message;
+        REQUIRE(!is_error(messages::prepare_live_state(1, 16, "name", "map", "mode",
+                                                       "version", nullptr, message)));
+        std::array<char, 256> data;
+        size_t length = 0;
+        REQUIRE(!is_error(
+            codec::message_to_data(1, message, data.data(), data.size(), length)));
+        REQUIRE(stats(allocator::Subsystem::payload).allocations > 0);
+
+        Message decoded;
+        codec::Header header{};
+        size_t read = 0;
+        REQUIRE(!is_error(codec::data_to_message(data.data(), length, read, header, decoded)));
+        allocator::reset_stats();
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(!is_error(
+                codec::data_to_message(data.data(), length, read, header, decoded)));
+        }
+        REQUIRE(stats(allocator::Subsystem::all).allocations == 0);
+    }
+    REQUIRE(stats(allocator::Subsystem::all).bytes == 0);
+
+    // C API.
+    OneAllocationStats c_stats;
+    OneArrayPtr array = nullptr;
+    REQUIRE(!is_error(one_array_create(&array)));
+    REQUIRE(!is_error(one_allocator_stats(ONE_ALLOCATION_SUBSYSTEM_C_API, &c_stats)));
+    REQUIRE(c_stats.allocations == 1);
+    REQUIRE(c_stats.bytes > 0);
+    one_array_destroy(array);
+    REQUIRE(!is_error(one_allocator_stats(ONE_ALLOCATION_SUBSYSTEM_ALL, &c_stats)));
+    REQUIRE(c_stats.bytes == 0);
+    REQUIRE(one_allocator_stats(ONE_ALLOCATION_SUBSYSTEM_ALL, nullptr) ==
+            ONE_ERROR_VALIDATION_STATS_IS_NULLPTR);
+    REQUIRE(one_allocator_stats(static_cast<OneAllocationSubsystem>(-1), &c_stats) ==
+            ONE_ERROR_VALIDATION_SUBSYSTEM_IS_INVALID);
+}
+
 TEST_CASE("custom string", "[arcus]") {
     SECTION("default allocation") {
         {
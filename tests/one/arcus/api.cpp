@@ -2,9 +2,14 @@
 #include <one/arcus/c_error.h>
 #include <one/arcus/c_api.h>
 #include <one/arcus/c_platform.h>
+#include <one/arcus/array.h>
+#include <one/arcus/object.h>
 #include <one/arcus/server.h>
 #include <tests/one/arcus/util.h>
 
+#include <atomic>
+#include <thread>
+
 // C API tests.
 // Most of the api is indirectly tested via the integration tests, however
 // more detailed tests may be added here.
@@ -29,7 +34,374 @@ TEST_CASE("customer logger", "[capi]") {
     REQUIRE(_was_log_called);
 }
 
+struct SoftStopReceived {
+    int timeout = 0;
+    std::thread::id thread;
+};
+
+TEST_CASE("server io thread", "[capi]") {
+    constexpr auto port = 9003;
+    OneServerPtr server;
+    REQUIRE(!one_is_error(one_server_create_with_io_thread(port, &server)));
+
+    SoftStopReceived received;
+    REQUIRE(!one_is_error(one_server_set_soft_stop_callback(
+        server,
+        [](void *userdata, int timeout) {
+            auto r = reinterpret_cast<SoftStopReceived *>(userdata);
+            r->timeout = timeout;
+            r->thread = std::this_thread::get_id();
+        },
+        &received)));
+
+    // The background thread handshakes without the server being updated.
+    i3d::one::Agent agent;
+    REQUIRE(!one_is_error(agent.init("127.0.0.1", port)));
+    OneServerStatus status = ONE_SERVER_STATUS_UNINITIALIZED;
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        agent.update();
+        REQUIRE(!one_is_error(one_server_status(server, &status)));
+        return status == ONE_SERVER_STATUS_READY &&
+               agent.client().status() == i3d::one::Client::Status::ready;
+    }));
+
+    // Incoming messages are only dispatched by update, on the updating thread.
+    REQUIRE(!one_is_error(agent.send_soft_stop(1000)));
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        agent.update();
+        REQUIRE(!one_is_error(one_server_update(server)));
+        return received.timeout != 0;
+    }));
+    REQUIRE(received.timeout == 1000);
+    REQUIRE(received.thread == std::this_thread::get_id());
+
+    one_server_destroy(server);
+}
+
+TEST_CASE("server io thread concurrent updates", "[capi]") {
+    constexpr auto port = 9008;
+    i3d::one::Server server;
+    REQUIRE(!one_is_error(server.init(port, i3d::one::Server::Threading::io_thread)));
+
+    std::atomic<int> received(0);
+    const auto on_soft_stop = [](void *userdata, int) {
+        ++*reinterpret_cast<std::atomic<int> *>(userdata);
+    };
+    REQUIRE(!one_is_error(server.set_soft_stop_callback(on_soft_stop, &received)));
+
+    i3d::one::Agent agent;
+    REQUIRE(!one_is_error(agent.init("127.0.0.1", port)));
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        agent.update();
+        return server.status() == i3d::one::Server::Status::ready &&
+               agent.client().status() == i3d::one::Client::Status::ready;
+    }));
+
+    // Several threads update, and set the callback, logger and properties,
+    // while the messages arrive. Each message is dispatched once.
+    std::atomic<bool> is_updating(true);
+    std::atomic<int> failures(0);
+    std::atomic<int> logs(0);
+    const i3d::one::Logger logger(
+        [](void *userdata, i3d::one::LogLevel, const i3d::one::String &) {
+            ++*reinterpret_cast<std::atomic<int> *>(userdata);
+        },
+        &logs);
+    const auto update = [&]() {
+        int players = 0;
+        while (is_updating) {
+            server.set_logger(logger);
+            if (one_is_error(server.update())) ++failures;
+            if (one_is_error(server.set_soft_stop_callback(on_soft_stop, &received)))
+                ++failures;
+            if (one_is_error(server.set_live_state(++players % 16, 16, "name", "map",
+                                                   "mode", "version", nullptr)))
+                ++failures;
+        }
+    };
+    std::thread first(update);
+    std::thread second(update);
+
+    constexpr int count = 20;
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(!one_is_error(agent.send_soft_stop(1000)));
+    }
+    const bool has_received = i3d::one::wait_until(2000, [&]() -> bool {
+        agent.update();
+        return received == count;
+    });
+    is_updating = false;
+    first.join();
+    second.join();
+    REQUIRE(has_received);
+    REQUIRE(failures == 0);
+
+    // Shutting down while another thread updates.
+    is_updating = true;
+    std::thread updater([&]() {
+        while (is_updating) {
+            server.update();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(!one_is_error(server.shutdown()));
+    REQUIRE(server.update() == ONE_ERROR_SERVER_SOCKET_NOT_INITIALIZED);
+    is_updating = false;
+    updater.join();
+}
+
+TEST_CASE("server property queue", "[capi]") {
+    OneServerPtr server;
+    REQUIRE(!one_is_error(one_server_create(9004, &server)));
+
+    // Setters queue changes until the server is updated, keeping only the
+    // latest ones once the queue is full.
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(!one_is_error(one_server_set_application_instance_status(
+            server, (i % 2 == 0) ? ONE_SERVER_ONLINE : ONE_SERVER_ALLOCATED)));
+        REQUIRE(!one_is_error(one_server_set_live_state(server, i, 1000, "name", "map",
+                                                        "mode", "version", nullptr)));
+    }
+
+    REQUIRE(!one_is_error(one_server_update(server)));
+    REQUIRE(!one_is_error(one_server_set_live_state(server, 1, 16, "name", "map",
+                                                    "mode", "version", nullptr)));
+
+    // Reverse metadata needs a connected client.
+    OneArrayPtr data;
+    REQUIRE(!one_is_error(one_array_create(&data)));
+    REQUIRE(one_server_send_reverse_metadata(server, data) ==
+            ONE_ERROR_SERVER_CONNECTION_NOT_READY);
+    one_array_destroy(data);
+
+    one_server_destroy(server);
+}
+
+TEST_CASE("server property overflow", "[capi]") {
+    constexpr auto port = 9009;
+    i3d::one::Server server;
+
+    // Set before init, more often than the queue holds. Only the latest are
+    // sent.
+    i3d::one::Object data;
+    for (int i = 1; i <= 1000; ++i) {
+        REQUIRE(!one_is_error(data.set_val_int("key", i % 3)));
+        REQUIRE(!one_is_error(server.set_live_state(i, 1000, "name", "map", "mode",
+                                                    "version", &data)));
+        REQUIRE(!one_is_error(server.set_application_instance_status(
+            (i % 2 == 0) ? i3d::one::Server::ApplicationInstanceStatus::online
+                         : i3d::one::Server::ApplicationInstanceStatus::allocated)));
+    }
+    REQUIRE(!one_is_error(server.init(port)));
+
+    i3d::one::Agent agent;
+    REQUIRE(!one_is_error(agent.init("127.0.0.1", port)));
+    int received = 0;
+    int players = 0;
+    int status = 0;
+    REQUIRE(!one_is_error(agent.set_live_state_callback(
+        [&](void *, int p, int, const i3d::one::String &, const i3d::one::String &,
+            const i3d::one::String &, const i3d::one::String &) {
+            ++received;
+            players = p;
+        },
+        nullptr)));
+    REQUIRE(!one_is_error(agent.set_application_instance_status_callback(
+        [&](void *, int s) { status = s; }, nullptr)));
+    const auto update = [&]() {
+        REQUIRE(!one_is_error(server.update()));
+        agent.update();
+    };
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        update();
+        return players != 0 && status != 0;
+    }));
+    REQUIRE(players == 1000);
+    REQUIRE(status == static_cast<int>(i3d::one::Server::ApplicationInstanceStatus::online));
+    REQUIRE(received == 1);
+
+    // Messages are not merged, they fail once the queue is full.
+    i3d::one::Array metadata;
+    metadata.push_back_string("value");
+    OneError err = ONE_ERROR_NONE;
+    int sent = 0;
+    for (; sent < 1000 && !one_is_error(err); ++sent) {
+        err = server.send_reverse_metadata(&metadata);
+    }
+    REQUIRE(err == ONE_ERROR_SERVER_PROPERTY_QUEUE_FULL);
+    REQUIRE(1 < sent);
+    update();
+    REQUIRE(!one_is_error(server.send_reverse_metadata(&metadata)));
+
+    REQUIRE(!one_is_error(server.shutdown()));
+}
+
+TEST_CASE("server live state changes", "[capi]") {
+    constexpr auto port = 9005;
+    OneServerPtr server;
+    REQUIRE(!one_is_error(one_server_create(port, &server)));
+
+    i3d::one::Agent agent;
+    REQUIRE(!one_is_error(agent.init("127.0.0.1", port)));
+    const auto update = [&]() {
+        REQUIRE(!one_is_error(one_server_update(server)));
+        agent.update();
+    };
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        update();
+        return agent.client().status() == i3d::one::Client::Status::ready;
+    }));
+
+    // Sets the live state, and returns the number of live states the agent
+    // has received once things settled.
+    const auto set = [&](int players, OneObjectPtr data) -> int {
+        REQUIRE(!one_is_error(one_server_set_live_state(server, players, 16, "name",
+                                                        "map", "mode", "version", data)));
+        i3d::one::for_sleep(20, 1, [&]() {
+            update();
+            return false;
+        });
+        return agent.live_state_receive_count();
+    };
+
+    REQUIRE(set(1, nullptr) == 1);
+    // Only changes are sent.
+    REQUIRE(set(1, nullptr) == 1);
+    REQUIRE(set(2, nullptr) == 2);
+    // Nor changes reverted before the next update.
+    REQUIRE(!one_is_error(one_server_set_live_state(server, 3, 16, "name", "map", "mode",
+                                                    "version", nullptr)));
+    REQUIRE(set(2, nullptr) == 2);
+
+    // Including changes of the additional data alone, by content.
+    OneObjectPtr data;
+    REQUIRE(!one_is_error(one_object_create(&data)));
+    REQUIRE(!one_is_error(one_object_set_val_int(data, "key", 1)));
+    REQUIRE(set(2, data) == 3);
+    REQUIRE(set(2, data) == 3);
+    OneObjectPtr same;
+    REQUIRE(!one_is_error(one_object_create(&same)));
+    REQUIRE(!one_is_error(one_object_set_val_int(same, "key", 1)));
+    REQUIRE(set(2, same) == 3);
+    REQUIRE(!one_is_error(one_object_set_val_int(data, "key", 2)));
+    REQUIRE(set(2, data) == 4);
+    REQUIRE(set(2, nullptr) == 5);
+    one_object_destroy(data);
+    one_object_destroy(same);
+
+    one_server_destroy(server);
+}
+
+TEST_CASE("server live state coalescing", "[capi]") {
+    constexpr auto port = 9006;
+    OneServerPtr server;
+    REQUIRE(!one_is_error(one_server_create(port, &server)));
+    REQUIRE(one_server_set_live_state_coalescing(server, 100, 50) ==
+            ONE_ERROR_SERVER_INVALID_LIVE_STATE_COALESCING);
+    // The window is much longer than the time the test takes to set a burst,
+    // so that the burst is coalesced even on a slow machine.
+    REQUIRE(!one_is_error(one_server_set_live_state_coalescing(server, 1000, 2000)));
+
+    i3d::one::Agent agent;
+    REQUIRE(!one_is_error(agent.init("127.0.0.1", port)));
+    int received = 0;
+    int players = 0;
+    REQUIRE(!one_is_error(agent.set_live_state_callback(
+        [&](void *, int p, int, const i3d::one::String &, const i3d::one::String &,
+            const i3d::one::String &, const i3d::one::String &) {
+            ++received;
+            players = p;
+        },
+        nullptr)));
+    const auto update = [&]() {
+        REQUIRE(!one_is_error(one_server_update(server)));
+        agent.update();
+    };
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        update();
+        OneServerStatus status = ONE_SERVER_STATUS_UNINITIALIZED;
+        REQUIRE(!one_is_error(one_server_status(server, &status)));
+        return status == ONE_SERVER_STATUS_READY &&
+               agent.client().status() == i3d::one::Client::Status::ready;
+    }));
+
+    const auto set = [&](int p) {
+        REQUIRE(!one_is_error(one_server_set_live_state(server, p, 16, "name", "map",
+                                                        "mode", "version", nullptr)));
+        update();
+    };
+
+    // A burst is sent once, as its latest state, once it settled.
+    for (int p = 1; p <= 5; ++p) {
+        set(p);
+    }
+    REQUIRE(i3d::one::wait_until(5000, [&]() -> bool {
+        update();
+        return received > 0;
+    }));
+    REQUIRE(received == 1);
+    REQUIRE(players == 5);
+
+    // Continuous changes are still sent, within the max delay.
+    bool was_received = false;
+    for (int i = 0; i < 1000 && !was_received; ++i) {
+        set(10 + i);
+        i3d::one::sleep(10);
+        was_received = (received == 2);
+    }
+    REQUIRE(was_received);
+    REQUIRE(players >= 10);
+
+    one_server_destroy(server);
+}
+
 #ifdef ONE_WINDOWS  // On linux, listen may succeed even if already listened on.
+TEST_CASE("server stats", "[capi]") {
+    constexpr auto port = 9007;
+    OneServerPtr server;
+    REQUIRE(!one_is_error(one_server_create(port, &server)));
+
+    OneServerStats stats{};
+    REQUIRE(one_server_stats(nullptr, &stats) == ONE_ERROR_VALIDATION_SERVER_IS_NULLPTR);
+    REQUIRE(one_server_stats(server, nullptr) == ONE_ERROR_VALIDATION_STATS_IS_NULLPTR);
+
+    // Read from another thread while the server updates.
+    std::atomic<bool> is_reading(true);
+    std::atomic<int> failures(0);
+    std::thread reader([&]() {
+        OneServerStats read{};
+        while (is_reading) {
+            if (one_is_error(one_server_stats(server, &read))) ++failures;
+        }
+    });
+
+    i3d::one::Agent agent;
+    REQUIRE(!one_is_error(agent.init("127.0.0.1", port)));
+    REQUIRE(i3d::one::wait_until(2000, [&]() -> bool {
+        agent.update();
+        REQUIRE(!one_is_error(one_server_update(server)));
+        OneServerStatus status = ONE_SERVER_STATUS_UNINITIALIZED;
+        REQUIRE(!one_is_error(one_server_status(server, &status)));
+        return status == ONE_SERVER_STATUS_READY;
+    }));
+    is_reading = false;
+    reader.join();
+    REQUIRE(failures == 0);
+
+    // The handshake is counted in both directions.
+    REQUIRE(!one_is_error(one_server_stats(server, &stats)));
+    REQUIRE(stats.messages_in > 0);
+    REQUIRE(stats.messages_out > 0);
+    REQUIRE(stats.bytes_in > 0);
+    REQUIRE(stats.bytes_out > 0);
+    REQUIRE(stats.update_time > 0);
+    REQUIRE(stats.io_time <= stats.update_time);
+    REQUIRE(stats.connection_time <= stats.io_time);
+    REQUIRE(stats.outgoing_queue_peak > 0);
+
+    one_server_destroy(server);
+}
+
 TEST_CASE("server port retry", "[capi]") {
     i3d::one::server::set_listen_retry_delay(1);
 
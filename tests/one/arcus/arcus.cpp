@@ -1,12 +1,15 @@
 #include <catch.hpp>
 #include <tests/one/arcus/util.h>
 
+#include <array>
+#include <cstring>
 #include <functional>
 #include <utility>
 
 #include <one/arcus/array.h>
 #include <one/arcus/internal/codec.h>
 #include <one/arcus/internal/connection.h>
+#include <one/arcus/internal/poller.h>
 #include <one/arcus/internal/socket.h>
 #include <one/arcus/internal/version.h>
 #include <one/arcus/error.h>
@@ -177,6 +180,19 @@ TEST_CASE("connection", "[arcus]") {
     REQUIRE(received == 1);
     REQUIRE(in_data[0] == out_data);
 
+    // Send two buffers at once.
+    wait_ready_for_send(out_client);
+    result = out_client.send("ab", 2, "cde", 3, sent);
+    REQUIRE(!is_error(result));
+    REQUIRE(sent == 5);
+    REQUIRE(wait_until(1000, [&]() {
+        size_t part = 0;
+        REQUIRE(!is_error(in_client.receive(in_data + received, 128 - received, part)));
+        received += part;
+        return received == 6;
+    }));
+    REQUIRE(std::memcmp(in_data, "aabcde", 6) == 0);
+
     //-------------
     // Handshaking.
 
@@ -231,6 +247,162 @@ TEST_CASE("connection", "[arcus]") {
     shutdown_socket_system();
 }
 
+// Socket readiness tracked by a Poller.
+TEST_CASE("socket poller", "[arcus]") {
+    init_socket_system();
+    Poller poller;
+#ifndef ONE_ARCUS_EPOLL
+    REQUIRE(poller.init() == ONE_ERROR_SOCKET_POLLER_UNAVAILABLE);
+#else
+    REQUIRE(!is_error(poller.init()));
+
+    Socket server;
+    unsigned int server_port;
+    listen(server, server_port);
+    REQUIRE(!is_error(poller.add(server)));
+    REQUIRE(server.poller() == &poller);
+
+    // Nothing to accept, the listen socket is no longer ready until polled.
+    Socket in_client;
+    String client_ip;
+    unsigned int client_port;
+    REQUIRE(!is_error(server.accept(in_client, client_ip, client_port)));
+    REQUIRE(in_client.is_initialized() == false);
+    bool is_ready = true;
+    REQUIRE(!is_error(server.ready_for_read(0.f, is_ready)));
+    REQUIRE(is_ready == false);
+
+    // A connecting client makes it ready.
+    Socket out_client;
+    connect(out_client, server_port);
+    REQUIRE(wait_until(1000, [&]() {
+        REQUIRE(!is_error(poller.update()));
+        REQUIRE(!is_error(server.ready_for_read(0.f, is_ready)));
+        return is_ready;
+    }));
+    REQUIRE(!is_error(server.accept(in_client, client_ip, client_port)));
+    REQUIRE(in_client.is_initialized());
+    REQUIRE(!is_error(poller.add(in_client)));
+
+    // Receiving until the socket would block clears its readiness.
+    unsigned char data[128] = {0};
+    size_t received = 0;
+    REQUIRE(!is_error(in_client.receive(data, sizeof(data), received)));
+    REQUIRE(received == 0);
+    REQUIRE(!is_error(in_client.ready_for_read(0.f, is_ready)));
+    REQUIRE(is_ready == false);
+
+    // Incoming data makes it ready again once polled.
+    size_t sent = 0;
+    REQUIRE(!is_error(out_client.send("ab", 2, sent)));
+    REQUIRE(sent == 2);
+    REQUIRE(wait_until(1000, [&]() {
+        REQUIRE(!is_error(poller.update()));
+        REQUIRE(!is_error(in_client.ready_for_read(0.f, is_ready)));
+        return is_ready;
+    }));
+    REQUIRE(!is_error(in_client.receive(data, sizeof(data), received)));
+    REQUIRE(received == 2);
+    REQUIRE(data[0] == 'a');
+    REQUIRE(data[1] == 'b');
+
+    // The partial receive drained the socket.
+    REQUIRE(!is_error(in_client.ready_for_read(0.f, is_ready)));
+    REQUIRE(is_ready == false);
+    REQUIRE(!is_error(in_client.ready_for_send(0.f, is_ready)));
+    REQUIRE(is_ready);
+
+    // Connections work over polled sockets.
+    Connection server_connection(2, 2);
+    server_connection.init(in_client);
+    Connection client_connection(2, 2);
+    client_connection.init(out_client);
+    server_connection.initiate_handshake();
+    REQUIRE(wait_until(1000, [&]() {
+        REQUIRE(!is_error(poller.update()));
+        REQUIRE(!is_error(server_connection.update()));
+        REQUIRE(!is_error(client_connection.update()));
+        return server_connection.status() == Connection::Status::ready &&
+               client_connection.status() == Connection::Status::ready;
+    }));
+
+    // Closing removes the sockets from the poller.
+    in_client.close();
+    REQUIRE(in_client.poller() == nullptr);
+    server.close();
+    REQUIRE(server.poller() == nullptr);
+    out_client.close();
+#endif
+    shutdown_socket_system();
+}
+
+// A message received over several updates of a polled socket.
+TEST_CASE("socket poller partial message", "[arcus]") {
+#ifdef ONE_ARCUS_EPOLL
+    init_socket_system();
+    Poller poller;
+    REQUIRE(!is_error(poller.init()));
+
+    Socket server;
+    unsigned int server_port;
+    listen(server, server_port);
+    Socket out_client;
+    connect(out_client, server_port);
+    Socket in_client;
+    accept(server, in_client);
+    REQUIRE(!is_error(poller.add(in_client)));
+
+    Connection server_connection(2, 2);
+    server_connection.init(in_client);
+    Connection client_connection(2, 2);
+    client_connection.init(out_client);
+    server_connection.initiate_handshake();
+    REQUIRE(wait_until(1000, [&]() {
+        REQUIRE(!is_error(poller.update()));
+        REQUIRE(!is_error(server_connection.update()));
+        REQUIRE(!is_error(client_connection.update()));
+        return server_connection.status() == Connection::Status::ready &&
+               client_connection.status() == Connection::Status::ready;
+    }));
+
+    // The header and part of the payload first.
+    Message message;
+    messages::prepare_soft_stop(1000, message);
+    std::array<char, codec::header_size() + codec::payload_max_size()> data;
+    size_t length = 0;
+    REQUIRE(!is_error(codec::message_to_data(1, message, data.data(), data.size(), length)));
+    const size_t first_part = codec::header_size() + 2;
+    REQUIRE(first_part < length);
+    size_t sent = 0;
+    REQUIRE(!is_error(out_client.send(data.data(), first_part, sent)));
+    REQUIRE(sent == first_part);
+
+    // The updates return while the rest is missing, once the socket is drained.
+    unsigned int count = 0;
+    for_sleep(10, 10, [&]() {
+        REQUIRE(!is_error(poller.update()));
+        REQUIRE(!is_error(server_connection.update()));
+        return false;
+    });
+    REQUIRE(!is_error(server_connection.incoming_count(count)));
+    REQUIRE(count == 0);
+
+    REQUIRE(!is_error(out_client.send(data.data() + first_part, length - first_part, sent)));
+    REQUIRE(sent == length - first_part);
+    REQUIRE(wait_until(1000, [&]() {
+        REQUIRE(!is_error(poller.update()));
+        REQUIRE(!is_error(server_connection.update()));
+        REQUIRE(!is_error(server_connection.incoming_count(count)));
+        return count == 1;
+    }));
+
+    in_client.close();
+    server.close();
+    out_client.close();
+    shutdown_socket_system();
+#endif
+}
+
 struct ClientServerTestObjects {
     Socket server;
     Socket out_client;
@@ -241,7 +413,8 @@ struct ClientServerTestObjects {
 };
 
 void init_client_server_test(ClientServerTestObjects &objects,
-                             size_t message_queue_length) {
+                             size_t message_queue_length, bool is_server_binary = false,
+                             bool is_client_binary = false) {
     init_socket_system();
 
     listen(objects.server, objects.server_port);
@@ -249,9 +422,11 @@ void init_client_server_test(ClientServerTestObjects &objects,
     accept(objects.server, objects.in_client);
     objects.server_connection =
         new Connection(message_queue_length, message_queue_length);
+    objects.server_connection->set_binary_payloads_supported(is_server_binary);
     objects.server_connection->init(objects.in_client);
     objects.client_connection =
         new Connection(message_queue_length, message_queue_length);
+    objects.client_connection->set_binary_payloads_supported(is_client_binary);
     objects.client_connection->init(objects.out_client);
 }
 
@@ -434,6 +609,159 @@ TEST_CASE("message send and receive", "[arcus]") {
     shutdown_client_server_test(objects);
 }
 
+TEST_CASE("message send batched", "[arcus]") {
+    ClientServerTestObjects objects;
+    constexpr size_t queue_length = 16;
+    init_client_server_test(objects, queue_length);
+    handshake_client_server_test(objects);
+
+    // All queued messages are sent by a single update.
+    for (size_t i = 0; i < queue_length; ++i) {
+        Message message;
+        messages::prepare_soft_stop(static_cast<int>(i), message);
+        REQUIRE(!is_error(objects.client_connection->add_outgoing(std::move(message))));
+    }
+    REQUIRE(!is_error(objects.client_connection->update()));
+
+    unsigned int count = 0;
+    REQUIRE(wait_until(1000, [&]() {
+        REQUIRE(!is_error(objects.server_connection->update()));
+        REQUIRE(!is_error(objects.server_connection->incoming_count(count)));
+        return count == queue_length;
+    }));
+
+    // In order.
+    for (size_t i = 0; i < queue_length; ++i) {
+        auto err = objects.server_connection->remove_incoming([&](const Message &message) {
+            int timeout = -1;
+            REQUIRE(!is_error(message.payload().val_int("timeout", timeout)));
+            REQUIRE(timeout == static_cast<int>(i));
+            return ONE_ERROR_NONE;
+        });
+        REQUIRE(!is_error(err));
+    }
+
+    shutdown_client_server_test(objects);
+}
+
+TEST_CASE("message send binary payloads", "[arcus]") {
+    // Binary payloads are used only if both sides support them.
+    const bool sides[][3] = {
+        // Server, client, negotiated.
+        {true, true, true},
+        {true, false, false},
+        {false, true, false},
+    };
+    for (const auto &side : sides) {
+        ClientServerTestObjects objects;
+        init_client_server_test(objects, 2, side[0], side[1]);
+        handshake_client_server_test(objects);
+        REQUIRE(objects.server_connection->is_binary_negotiated() == side[2]);
+        REQUIRE(objects.client_connection->is_binary_negotiated() == side[2]);
+
+        Array array;
+        array.push_back_int(-70000);
+        array.push_back_string("text");
+        Message message;
+        REQUIRE(!is_error(messages::prepare_metadata(array, message)));
+        REQUIRE(!is_error(objects.server_connection->add_outgoing(message)));
+        REQUIRE(!is_error(objects.client_connection->add_outgoing(message)));
+
+        unsigned int server_count = 0;
+        unsigned int client_count = 0;
+        REQUIRE(wait_until(1000, [&]() {
+            REQUIRE(!is_error(objects.server_connection->update()));
+            REQUIRE(!is_error(objects.client_connection->update()));
+            REQUIRE(!is_error(objects.server_connection->incoming_count(server_count)));
+            REQUIRE(!is_error(objects.client_connection->incoming_count(client_count)));
+            return server_count == 1 && client_count == 1;
+        }));
+
+        const auto check = [&](const Message &received) {
+            REQUIRE(received.code() == Opcode::metadata);
+            REQUIRE(received.payload().get() == message.payload().get());
+            return ONE_ERROR_NONE;
+        };
+        REQUIRE(!is_error(objects.server_connection->remove_incoming(check)));
+        REQUIRE(!is_error(objects.client_connection->remove_incoming(check)));
+
+        shutdown_client_server_test(objects);
+    }
+}
+
+TEST_CASE("message send binary payload not negotiated", "[arcus]") {
+    ClientServerTestObjects objects;
+    init_client_server_test(objects, 2);
+    handshake_client_server_test(objects);
+
+    Message message;
+    REQUIRE(!is_error(messages::prepare_soft_stop(1000, message)));
+    std::array<char, 256> data;
+    size_t length = 0;
+    REQUIRE(!is_error(codec::message_to_data(1, message, data.data(), data.size(), length,
+                                             codec::PayloadEncoding::binary)));
+    size_t sent = 0;
+    REQUIRE(!is_error(objects.out_client.send(data.data(), length, sent)));
+    REQUIRE(sent == length);
+
+    OneError err = ONE_ERROR_NONE;
+    wait_until(1000, [&]() {
+        err = objects.server_connection->update();
+        return is_error(err);
+    });
+    REQUIRE(err == ONE_ERROR_CONNECTION_BINARY_PAYLOAD_NOT_NEGOTIATED);
+
+    shutdown_client_server_test(objects);
+}
+
+TEST_CASE("message send and receive wrapping the stream buffers", "[arcus]") {
+    ClientServerTestObjects objects;
+    constexpr size_t queue_length = 8;
+    init_client_server_test(objects, queue_length);
+    handshake_client_server_test(objects);
+
+    // Large messages with a size that does not divide the stream buffer sizes,
+    // so that messages end up wrapping around the end of the stream buffers.
+    Array array;
+    const String value(1000, 'x');
+    for (int i = 0; i < 23; ++i) {
+        array.push_back_string(value);
+    }
+    Message message;
+    REQUIRE(!is_error(messages::prepare_metadata(array, message)));
+
+    // Send enough data to pass through the stream buffers several times.
+    const int message_count = 64;
+    int received_count = 0;
+    for (int i = 0; i < message_count; ++i) {
+        REQUIRE(!is_error(objects.client_connection->add_outgoing(message)));
+
+        for_sleep(10, 1, [&]() {
+            REQUIRE(!is_error(objects.client_connection->update()));
+            REQUIRE(!is_error(objects.server_connection->update()));
+
+            unsigned int count = 0;
+            REQUIRE(!is_error(objects.server_connection->incoming_count(count)));
+            for (unsigned int j = 0; j < count; ++j) {
+                auto err = objects.server_connection->remove_incoming(
+                    [&](const Message &incoming) {
+                        REQUIRE(incoming.code() == Opcode::metadata);
+                        Array data;
+                        REQUIRE(!is_error(incoming.payload().val_array("data", data)));
+                        REQUIRE(data.get() == array.get());
+                        received_count++;
+                        return ONE_ERROR_NONE;
+                    });
+                REQUIRE(!is_error(err));
+            }
+            return received_count == i + 1;
+        });
+    }
+    REQUIRE(received_count == message_count);
+
+    shutdown_client_server_test(objects);
+}
+
 TEST_CASE("message send bad json", "[arcus]") {
     ClientServerTestObjects objects;
     constexpr size_t queue_length = 1024;
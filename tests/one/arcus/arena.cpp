@@ -0,0 +1,115 @@
+#include <catch.hpp>
+#include <one/arcus/allocator.h>
+#include <one/arcus/internal/arena.h>
+#include <one/arcus/internal/codec.h>
+#include <one/arcus/message.h>
+#include <one/arcus/object.h>
+
+#include <array>
+#include <cstdlib>
+
+using namespace i3d::one;
+
+namespace {
+
+size_t _alloc_count = 0;
+
+// Counts allocations made through the one allocator while in scope.
+class ScopedAllocationCounter final {
+public:
+    ScopedAllocationCounter() {
+        _alloc_count = 0;
+        allocator::set_alloc([](size_t bytes) -> void * {
+            _alloc_count++;
+            return std::malloc(bytes);
+        });
+    }
+    ~ScopedAllocationCounter() {
+        allocator::reset_overrides();
+    }
+};
+
+}  // namespace
+
+TEST_CASE("arena", "[arcus]") {
+    Arena arena;
+    REQUIRE(arena.capacity() == 0);
+    REQUIRE(arena.Malloc(0) == nullptr);
+
+    // Allocations are aligned and handed out from a single chunk.
+    char *a = reinterpret_cast<char *>(arena.Malloc(3));
+    char *b = reinterpret_cast<char *>(arena.Malloc(8));
+    REQUIRE(a != nullptr);
+    REQUIRE(b == a + 8);
+    REQUIRE(arena.size() == 16);
+    const size_t capacity = arena.capacity();
+    REQUIRE(capacity >= 16);
+
+    // The last allocation grows in place.
+    REQUIRE(arena.Realloc(b, 8, 16) == b);
+    REQUIRE(arena.size() == 24);
+
+    // Others are copied.
+    a[0] = 'x';
+    char *c = reinterpret_cast<char *>(arena.Realloc(a, 3, 16));
+    REQUIRE(c != a);
+    REQUIRE(c[0] == 'x');
+
+    // Reset reuses the memory.
+    arena.reset();
+    REQUIRE(arena.size() == 0);
+    REQUIRE(arena.capacity() == capacity);
+    REQUIRE(arena.Malloc(3) == a);
+
+    // Spilling over into more chunks is coalesced on reset.
+    REQUIRE(arena.Malloc(capacity) != nullptr);
+    REQUIRE(arena.capacity() > capacity);
+    const size_t grown = arena.capacity();
+    arena.reset();
+    REQUIRE(arena.capacity() == grown);
+    {
+        ScopedAllocationCounter counter;
+        REQUIRE(arena.Malloc(capacity) != nullptr);
+        REQUIRE(arena.Malloc(8) != nullptr);
+        REQUIRE(_alloc_count == 0);
+    }
+}
+
+TEST_CASE("message parsing reuses payload memory", "[arcus]") {
+    Object additional_data;
+    REQUIRE(!is_error(additional_data.set_val_string("key", "value")));
+    Message live_state;
+    REQUIRE(!is_error(messages::prepare_live_state(1, 16, "name", "map", "mode",
+                                                   "version", &additional_data,
+                                                   live_state)));
+
+    std::array<char, codec::header_size() + codec::payload_max_size()> data;
+    size_t data_length = 0;
+    REQUIRE(!is_error(codec::message_to_data(1, live_state, data_length, data)));
+
+    // Warm up.
+    Message message;
+    codec::Header header{};
+    size_t read = 0;
+    REQUIRE(!is_error(
+        codec::data_to_message(data.data(), data_length, read, header, message)));
+    REQUIRE(read == data_length);
+
+    ScopedAllocationCounter counter;
+    for (int i = 0; i < 8; ++i) {
+        REQUIRE(!is_error(
+            codec::data_to_message(data.data(), data_length, read, header, message)));
+    }
+    REQUIRE(_alloc_count == 0);
+    REQUIRE(message.code() == Opcode::live_state);
+    int players = 0;
+    REQUIRE(!is_error(message.payload().val_int("players", players)));
+    REQUIRE(players == 1);
+
+    // Copying into a warm message does not allocate either.
+    Message copy;
+    copy = message;
+    _alloc_count = 0;
+    copy = message;
+    REQUIRE(_alloc_count == 0);
+}
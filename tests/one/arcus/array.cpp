@@ -321,3 +321,29 @@ TEST_CASE("array c_api", "[array]") {
     one_array_destroy(a);
     one_array_destroy(nullptr);
 }
+
+TEST_CASE("array c_api pool", "[array]") {
+    one_array_pool_set_capacity(1);
+
+    OneArrayPtr a = nullptr;
+    REQUIRE(!is_error(one_array_create(&a)));
+    REQUIRE(!is_error(one_array_push_back_string(a, "value")));
+    one_array_destroy(a);
+
+    // The destroyed array is reused, and is empty.
+    OneArrayPtr b = nullptr;
+    REQUIRE(!is_error(one_array_create(&b)));
+    REQUIRE(b == a);
+    bool empty = false;
+    REQUIRE(!is_error(one_array_is_empty(b, &empty)));
+    REQUIRE(empty);
+
+    // Only up to the capacity is kept.
+    OneArrayPtr c = nullptr;
+    REQUIRE(!is_error(one_array_create(&c)));
+    REQUIRE(c != b);
+    one_array_destroy(b);
+    one_array_destroy(c);
+
+    one_array_pool_set_capacity(0);
+}
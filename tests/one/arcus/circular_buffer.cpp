@@ -0,0 +1,100 @@
+#include <catch.hpp>
+#include <one/arcus/internal/circular_buffer.h>
+
+#include <string.h>
+#include <cstring>
+
+using namespace i3d::one;
+
+TEST_CASE("circular buffer", "[arcus]") {
+    constexpr auto capacity = 8;
+    CircularBuffer buffer(capacity);
+    REQUIRE(buffer.capacity() == capacity);
+    REQUIRE(buffer.size() == 0);
+    REQUIRE(buffer.free_size() == capacity);
+
+    char *data = nullptr;
+    size_t length = 0;
+
+    // Fill it up.
+    const auto full = std::string("12345678");
+    buffer.put(full.data(), full.size());
+    REQUIRE(buffer.size() == full.size());
+    REQUIRE(buffer.free_size() == 0);
+
+    buffer.peek_write(reinterpret_cast<void **>(&data), length);
+    REQUIRE(length == 0);
+
+    // Check data is good.
+    buffer.peek_read(reinterpret_cast<void **>(&data), length);
+    REQUIRE(length == full.size());
+    REQUIRE(std::strncmp(data, full.data(), full.size()) == 0);
+
+    // Remove some, the remaining data must not move.
+    char *const front = data;
+    buffer.commit_read(6);
+    REQUIRE(buffer.size() == 2);
+    buffer.peek_read(reinterpret_cast<void **>(&data), length);
+    REQUIRE(length == 2);
+    REQUIRE(data == front + 6);
+    REQUIRE(std::strncmp(data, "78", 2) == 0);
+
+    // Write wraps around the end.
+    buffer.peek_write(reinterpret_cast<void **>(&data), length);
+    REQUIRE(data == front);
+    REQUIRE(length == 6);
+    buffer.put("abcd", 4);
+    REQUIRE(buffer.size() == 6);
+    REQUIRE(buffer.free_size() == 2);
+
+    // The readable span stops at the end of the buffer memory.
+    buffer.peek_read(reinterpret_cast<void **>(&data), length);
+    REQUIRE(length == 2);
+    REQUIRE(std::strncmp(data, "78", 2) == 0);
+
+    // Both spans together hold all data.
+    char *second = nullptr;
+    size_t second_length = 0;
+    buffer.peek_read(reinterpret_cast<void **>(&data), length,
+                     reinterpret_cast<void **>(&second), second_length);
+    REQUIRE(length == 2);
+    REQUIRE(std::strncmp(data, "78", 2) == 0);
+    REQUIRE(second == front);
+    REQUIRE(second_length == 4);
+    REQUIRE(std::strncmp(second, "abcd", 4) == 0);
+
+    // Linearize makes all data readable in one span.
+    buffer.linearize();
+    buffer.peek_read(reinterpret_cast<void **>(&data), length);
+    REQUIRE(data == front);
+    REQUIRE(length == 6);
+    REQUIRE(std::strncmp(data, "78abcd", 6) == 0);
+    buffer.peek_read(reinterpret_cast<void **>(&data), length,
+                     reinterpret_cast<void **>(&second), second_length);
+    REQUIRE(length == 6);
+    REQUIRE(second_length == 0);
+    buffer.peek_write(reinterpret_cast<void **>(&data), length);
+    REQUIRE(data == front + 6);
+    REQUIRE(length == 2);
+
+    // Direct write into the writable span.
+    std::memcpy(data, "ef", 2);
+    buffer.commit_write(2);
+    REQUIRE(buffer.size() == capacity);
+    buffer.peek_read(reinterpret_cast<void **>(&data), length);
+    REQUIRE(std::strncmp(data, "78abcdef", capacity) == 0);
+
+    // Emptying the buffer rewinds it to the start.
+    buffer.commit_read(3);
+    buffer.commit_read(5);
+    REQUIRE(buffer.size() == 0);
+    buffer.peek_write(reinterpret_cast<void **>(&data), length);
+    REQUIRE(data == front);
+    REQUIRE(length == capacity);
+
+    // Clear.
+    buffer.put(full.data(), 3);
+    buffer.clear();
+    REQUIRE(buffer.size() == 0);
+    REQUIRE(buffer.free_size() == capacity);
+}
@@ -2,15 +2,21 @@
 
 #include <functional>
 
+#include <one/arcus/array.h>
 #include <one/arcus/error.h>
+#include <one/arcus/internal/binary.h>
 #include <one/arcus/internal/codec.h>
 #include <one/arcus/internal/connection.h>
 #include <one/arcus/internal/messages.h>
+#include <one/arcus/internal/rapidjson/document.h>
 #include <one/arcus/message.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/types.h>
 
 #include <array>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 using namespace i3d::one;
 
@@ -41,6 +47,15 @@ TEST_CASE("hello", "[codec]") {
         hello.id[0] = (char)0x0;
         REQUIRE(!validate_hello(hello));
     }
+    {
+        auto hello = codec::valid_hello();
+        REQUIRE(!codec::is_binary_hello(hello));
+        hello = codec::binary_hello();
+        REQUIRE(validate_hello(hello));
+        REQUIRE(codec::is_binary_hello(hello));
+        hello.version = (char)0x3;
+        REQUIRE(!validate_hello(hello));
+    }
 
     // No Header validation in the Codec.
 }
@@ -54,7 +69,10 @@ TEST_CASE("header", "[codec]") {
     std::array<char, codec::header_size()> data;
     REQUIRE(!is_error(header_to_data(header, data)));
 
-    header.flags = (char)0x1;
+    header.flags = codec::header_flag_binary;
+    REQUIRE(codec::validate_header(header));
+
+    header.flags = (char)0x2;
     REQUIRE(!codec::validate_header(header));
     REQUIRE(is_error(header_to_data(header, data)));
 
@@ -113,6 +131,89 @@ TEST_CASE("payload", "[codec]") {
     REQUIRE(payload.get() == new_payload.get());
 }
 
+TEST_CASE("binary payload", "[codec]") {
+    const String json =
+        "{\"null\":null,\"bools\":[true,false],\"ints\":[0,127,128,255,256,65535,"
+        "65536,4294967295,4294967296,-1,-32,-33,-128,-129,-32768,-32769,-2147483648,"
+        "-2147483649,9223372036854775807,18446744073709551615],\"double\":-1.5,"
+        "\"strings\":[\"\",\"short\",\"a string longer than thirty-one bytes\"],"
+        "\"nested\":{\"a\":{\"b\":[[1],{}]}}}";
+    Payload payload;
+    REQUIRE(!is_error(payload.from_json({json.c_str(), json.size()})));
+
+    std::array<char, 1024> data;
+    size_t length = 0;
+    binary::write(payload.get(), data.data(), data.size(), length);
+    REQUIRE(0 < length);
+    REQUIRE(length < json.size());
+
+    Payload new_payload;
+    REQUIRE(!is_error(new_payload.from_binary({data.data(), length})));
+    REQUIRE(new_payload.get() == payload.get());
+    REQUIRE(new_payload.to_json() == json);
+
+    // The full length is reported when the data is too small.
+    size_t short_length = 0;
+    binary::write(payload.get(), data.data(), length - 1, short_length);
+    REQUIRE(short_length == length);
+
+    // Truncated and trailing data are rejected.
+    REQUIRE(is_error(new_payload.from_binary({data.data(), length - 1})));
+    REQUIRE(new_payload.is_empty());
+    REQUIRE(is_error(new_payload.from_binary({data.data(), length + 1})));
+
+    // The root must be an object.
+    const char array_root[] = {(char)0x90};
+    REQUIRE(is_error(new_payload.from_binary({array_root, sizeof(array_root)})));
+    // Map keys must be strings.
+    const char int_key[] = {(char)0x81, 0x01, 0x01};
+    REQUIRE(is_error(new_payload.from_binary({int_key, sizeof(int_key)})));
+    // Lengths larger than the data.
+    const char long_array[] = {(char)0x81, (char)0xa1, 'a', (char)0xdd, 0x7f, 0x0, 0x0, 0x0};
+    REQUIRE(is_error(new_payload.from_binary({long_array, sizeof(long_array)})));
+
+    // Nesting is limited.
+    std::vector<char> nested(binary::max_depth + 1, (char)0x91);
+    nested.front() = (char)0x81;
+    nested.insert(nested.begin() + 1, {(char)0xa1, 'a'});
+    nested.push_back((char)0xc0);
+    REQUIRE(is_error(new_payload.from_binary({nested.data(), nested.size()})));
+    nested.erase(nested.begin() + 3);
+    REQUIRE(!is_error(new_payload.from_binary({nested.data(), nested.size()})));
+}
+
+TEST_CASE("message binary payload", "[codec]") {
+    Message message;
+    REQUIRE(!is_error(messages::prepare_live_state(1, 16, "name test", "map test",
+                                                   "mode test", "version test", nullptr,
+                                                   message)));
+    std::array<char, 256> data;
+    size_t json_length = 0;
+    REQUIRE(!is_error(
+        codec::message_to_data(1, message, data.data(), data.size(), json_length)));
+
+    size_t length = 0;
+    REQUIRE(!is_error(codec::message_to_data(2, message, data.data(), data.size(), length,
+                                             codec::PayloadEncoding::binary)));
+    REQUIRE(length < json_length);
+
+    codec::Header header = {0};
+    Message new_message;
+    size_t data_read = 0;
+    REQUIRE(!is_error(
+        codec::data_to_message(data.data(), length, data_read, header, new_message)));
+    REQUIRE(data_read == length);
+    REQUIRE(header.flags == codec::header_flag_binary);
+    REQUIRE(new_message.code() == Opcode::live_state);
+    REQUIRE(new_message.payload().get() == message.payload().get());
+
+    // An empty payload has no data in either encoding.
+    message.init(Opcode::health, Payload());
+    REQUIRE(!is_error(codec::message_to_data(3, message, data.data(), data.size(), length,
+                                             codec::PayloadEncoding::binary)));
+    REQUIRE(length == codec::header_size());
+}
+
 TEST_CASE("message empty payload consistency", "[codec]") {
     codec::Header header = {0};
     Message message;
@@ -266,3 +367,81 @@ TEST_CASE("message", "[codec]") {
         REQUIRE(status == 4);
     }
 }
+
+TEST_CASE("message to raw data", "[codec]") {
+    codec::Header header = {0};
+    Message message;
+    Message new_message;
+    size_t data_length = 0;
+    size_t data_read = 0;
+    std::array<char, 256> data;
+
+    REQUIRE(!is_error(messages::prepare_soft_stop(1000, message)));
+    REQUIRE(!is_error(
+        codec::message_to_data(7, message, data.data(), data.size(), data_length)));
+    REQUIRE(data_length > codec::header_size());
+    REQUIRE(!is_error(codec::data_to_message(data.data(), data_length, data_read, header,
+                                             new_message)));
+    REQUIRE(data_length == data_read);
+    REQUIRE(header.packet_id == 7);
+    REQUIRE((Opcode)header.opcode == Opcode::soft_stop);
+    REQUIRE(new_message.payload().get() == message.payload().get());
+
+    // Destination too small for the header or the payload.
+    size_t length = 0;
+    REQUIRE(codec::message_to_data(8, message, data.data(), codec::header_size() - 1,
+                                   length) ==
+            ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE);
+    REQUIRE(codec::message_to_data(8, message, data.data(), data_length - 1, length) ==
+            ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_MESSAGE);
+    REQUIRE(!is_error(codec::message_to_data(8, message, data.data(), data_length, length)));
+    REQUIRE(length == data_length);
+
+    // Payload larger than the protocol maximum.
+    Array array;
+    array.push_back_string(String(codec::payload_max_size(), 'x'));
+    REQUIRE(!is_error(messages::prepare_metadata(array, message)));
+    std::vector<char> big_data(codec::header_size() + codec::payload_max_size() * 2);
+    REQUIRE(codec::message_to_data(9, message, big_data.data(), big_data.size(),
+                                   length) ==
+            ONE_ERROR_CODEC_INVALID_MESSAGE_PAYLOAD_SIZE_TOO_BIG);
+
+    // Payload that can't be written as JSON.
+    const char json[] = "{\"timeout\":1.5}";
+    REQUIRE(!is_error(message.init(Opcode::soft_stop, {json, sizeof(json) - 1})));
+    auto &value = const_cast<rapidjson::Value &>(message.payload().get());
+    value["timeout"].SetDouble(std::numeric_limits<double>::quiet_NaN());
+    REQUIRE(codec::message_to_data(10, message, data.data(), data.size(), length) ==
+            ONE_ERROR_CODEC_PAYLOAD_WRITE_FAILED);
+}
+
+TEST_CASE("message header without payload", "[codec]") {
+    // A health message with a payload that is not valid JSON.
+    const char payload[] = "not json";
+    const size_t payload_length = sizeof(payload) - 1;
+    codec::Header header = {0};
+    header.opcode = (char)Opcode::health;
+    header.length = payload_length;
+    std::array<char, codec::header_size() + payload_length> data;
+    std::array<char, codec::header_size()> header_data;
+    REQUIRE(!is_error(header_to_data(header, header_data)));
+    std::memcpy(data.data(), header_data.data(), codec::header_size());
+    std::memcpy(data.data() + codec::header_size(), payload, payload_length);
+
+    // The header and size are read without decoding the payload.
+    codec::Header new_header = {0};
+    size_t message_size = 0;
+    REQUIRE(codec::data_to_message_header(data.data(), data.size() - 1, message_size,
+                                          new_header) ==
+            ONE_ERROR_CODEC_DATA_LENGTH_TOO_SMALL_FOR_PAYLOAD);
+    REQUIRE(!is_error(
+        codec::data_to_message_header(data.data(), data.size(), message_size, new_header)));
+    REQUIRE(message_size == data.size());
+    REQUIRE(is_opcode_internal(static_cast<Opcode>(new_header.opcode)));
+
+    // Decoding the payload fails.
+    Message message;
+    size_t data_read = 0;
+    REQUIRE(is_error(codec::data_to_message(data.data(), data.size(), data_read, new_header,
+                                            message)));
+}
@@ -4,12 +4,15 @@
 #include <one/arcus/error.h>
 #include <one/arcus/array.h>
 #include <one/arcus/c_api.h>
+#include <one/arcus/internal/dispatch.h>
 #include <one/arcus/internal/rapidjson/document.h>
 #include <one/arcus/message.h>
 #include <one/arcus/object.h>
 #include <one/arcus/opcode.h>
 #include <one/arcus/types.h>
 
+#include <utility>
+
 using namespace i3d::one;
 
 TEST_CASE("payload unit tests", "[payload]") {
@@ -189,6 +192,47 @@ TEST_CASE("message unit tests", "[message]") {
     REQUIRE(timeout == 1000);
 }
 
+TEST_CASE("message move", "[message]") {
+    Message m;
+    const String json = "{\"timeout\":1000}";
+    REQUIRE(!is_error(m.init(Opcode::soft_stop, {json.c_str(), json.size()})));
+
+    Message moved(std::move(m));
+    REQUIRE(m.code() == Opcode::invalid);
+    REQUIRE(m.payload().is_empty());
+    REQUIRE(moved.code() == Opcode::soft_stop);
+    int timeout = 0;
+    REQUIRE(!is_error(moved.payload().val_int("timeout", timeout)));
+    REQUIRE(timeout == 1000);
+
+    // The moved from message stays usable.
+    REQUIRE(!is_error(m.init(Opcode::soft_stop, {json.c_str(), json.size()})));
+    m = std::move(moved);
+    REQUIRE(moved.payload().is_empty());
+    REQUIRE(!is_error(m.payload().val_int("timeout", timeout)));
+
+    Payload p;
+    REQUIRE(!is_error(p.set_val_int("timeout", 500)));
+    REQUIRE(!is_error(m.init(Opcode::soft_stop, std::move(p))));
+    REQUIRE(p.is_empty());
+    REQUIRE(!is_error(m.payload().val_int("timeout", timeout)));
+    REQUIRE(timeout == 500);
+
+    Array a;
+    a.push_back_int(1);
+    Array a_moved(std::move(a));
+    REQUIRE(a.is_empty());
+    REQUIRE(a_moved.size() == 1);
+    a = std::move(a_moved);
+    REQUIRE(a.size() == 1);
+
+    Object o;
+    REQUIRE(!is_error(o.set_val_int("key", 1)));
+    Object o_moved(std::move(o));
+    REQUIRE(o.is_empty());
+    REQUIRE(!o_moved.is_empty());
+}
+
 TEST_CASE("message prepare", "[message]") {
     Message m;
 
@@ -312,3 +356,54 @@ TEST_CASE("message prepare", "[message]") {
         REQUIRE(p.is_val_array("data"));
     }
 }
+
+TEST_CASE("message dispatch table", "[message]") {
+    DispatchTable table;
+    int received = 0;
+    const auto soft_stop = [](void *data, int timeout) {
+        *reinterpret_cast<int *>(data) = timeout;
+    };
+
+    // Opcodes without a callback are ignored.
+    Message m;
+    REQUIRE(!is_error(messages::prepare_soft_stop(1000, m)));
+    REQUIRE(!is_error(table.dispatch(m)));
+    REQUIRE(received == 0);
+
+    table.set<Opcode::soft_stop>(soft_stop, &received);
+    REQUIRE(!is_error(table.dispatch(m)));
+    REQUIRE(received == 1000);
+
+    // The payload is validated before calling the callback.
+    received = 0;
+    m.reset();
+    REQUIRE(!is_error(m.init(Opcode::soft_stop, {"{}", 2})));
+    REQUIRE(is_error(table.dispatch(m)));
+    REQUIRE(received == 0);
+
+    table.clear();
+    REQUIRE(!is_error(messages::prepare_soft_stop(1000, m)));
+    REQUIRE(!is_error(table.dispatch(m)));
+    REQUIRE(received == 0);
+}
+
+TEST_CASE("message outgoing validation", "[message]") {
+    using Outgoing = OpcodeList<Opcode::soft_stop, Opcode::metadata>;
+    bool is_listed = false;
+
+    Message m;
+    REQUIRE(!is_error(messages::prepare_soft_stop(1000, m)));
+    REQUIRE(!is_error(Outgoing::validate(m, is_listed)));
+    REQUIRE(is_listed);
+
+    m.reset();
+    REQUIRE(!is_error(m.init(Opcode::metadata, {"{}", 2})));
+    REQUIRE(is_error(Outgoing::validate(m, is_listed)));
+    REQUIRE(is_listed);
+
+    m.reset();
+    Array array;
+    REQUIRE(!is_error(messages::prepare_reverse_metadata(array, m)));
+    REQUIRE(!is_error(Outgoing::validate(m, is_listed)));
+    REQUIRE(!is_listed);
+}
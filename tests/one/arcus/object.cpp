@@ -205,6 +205,40 @@ TEST_CASE("object unit tests", "[object]") {
     REQUIRE(is_error(o.remove_key("bool")));
 }
 
+TEST_CASE("object hash", "[object]") {
+    Object a;
+    Object b;
+    REQUIRE(a.hash() == b.hash());
+
+    REQUIRE(!is_error(a.set_val_int("int", 1)));
+    REQUIRE(a.hash() != b.hash());
+    REQUIRE(!is_error(b.set_val_int("int", 1)));
+    REQUIRE(a.hash() == b.hash());
+
+    // Same text, other type.
+    Object c;
+    REQUIRE(!is_error(c.set_val_string("int", "1")));
+    REQUIRE(a.hash() != c.hash());
+
+    // Nested values.
+    Array array;
+    array.push_back_int(1);
+    REQUIRE(!is_error(a.set_val_array("array", array)));
+    REQUIRE(!is_error(b.set_val_array("array", array)));
+    REQUIRE(a.hash() == b.hash());
+    Object nested;
+    REQUIRE(!is_error(nested.set_val_bool("bool", true)));
+    REQUIRE(!is_error(a.set_val_object("object", nested)));
+    REQUIRE(a.hash() != b.hash());
+    REQUIRE(!is_error(nested.set_val_bool("bool", false)));
+    REQUIRE(!is_error(b.set_val_object("object", nested)));
+    REQUIRE(a.hash() != b.hash());
+
+    // Copies hash the same.
+    Object copy(a);
+    REQUIRE(copy.hash() == a.hash());
+}
+
 TEST_CASE("object c_api", "[object]") {
     OneObjectPtr o = nullptr;
     REQUIRE(!is_error(one_object_create(&o)));
@@ -325,3 +359,23 @@ TEST_CASE("object c_api", "[object]") {
     one_object_destroy(o);
     one_object_destroy(nullptr);
 }
+
+TEST_CASE("object c_api pool", "[object]") {
+    one_object_pool_set_capacity(1);
+
+    OneObjectPtr a = nullptr;
+    REQUIRE(!is_error(one_object_create(&a)));
+    REQUIRE(!is_error(one_object_set_val_int(a, "key", 1)));
+    one_object_destroy(a);
+
+    // The destroyed object is reused, and is empty.
+    OneObjectPtr b = nullptr;
+    REQUIRE(!is_error(one_object_create(&b)));
+    REQUIRE(b == a);
+    bool is_int = true;
+    REQUIRE(!is_error(one_object_is_val_int(b, "key", &is_int)));
+    REQUIRE(!is_int);
+    one_object_destroy(b);
+
+    one_object_pool_set_capacity(0);
+}
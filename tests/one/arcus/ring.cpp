@@ -1,6 +1,11 @@
 #include <catch.hpp>
 
 #include <one/arcus/internal/ring.h>
+#include <one/arcus/internal/spsc_ring.h>
+#include <one/arcus/message.h>
+
+#include <thread>
+#include <utility>
 
 using namespace i3d::one;
 
@@ -44,3 +49,91 @@ TEST_CASE("ring", "[arcus]") {
     REQUIRE(ring.pop() == 3);
     REQUIRE(ring.pop() == 4);
 }
+
+TEST_CASE("ring move", "[arcus]") {
+    Ring<Message> ring(2);
+
+    Message message;
+    const String json = "{\"timeout\":1000}";
+    REQUIRE(!is_error(message.init(Opcode::soft_stop, {json.c_str(), json.size()})));
+    ring.push(std::move(message));
+    REQUIRE(message.code() == Opcode::invalid);
+    REQUIRE(message.payload().is_empty());
+
+    ring.emplace();
+    REQUIRE(ring.size() == 2);
+
+    Message popped;
+    ring.pop(popped);
+    REQUIRE(popped.code() == Opcode::soft_stop);
+    int timeout = 0;
+    REQUIRE(!is_error(popped.payload().val_int("timeout", timeout)));
+    REQUIRE(timeout == 1000);
+
+    REQUIRE(ring.pop().code() == Opcode::invalid);
+    REQUIRE(ring.size() == 0);
+}
+
+TEST_CASE("spsc ring", "[arcus]") {
+    SpscRing<int> ring(2);
+    REQUIRE(ring.capacity() == 2);
+    REQUIRE(ring.size() == 0);
+    REQUIRE(ring.peek() == nullptr);
+
+    int i = 0;
+    REQUIRE(!ring.pop(i));
+
+    // Full pushes fail rather than overwrite.
+    REQUIRE(ring.push(1));
+    REQUIRE(ring.push(2));
+    REQUIRE(ring.size() == 2);
+    REQUIRE(ring.reserve() == nullptr);
+    REQUIRE(!ring.push(3));
+
+    REQUIRE(*ring.peek() == 1);
+    REQUIRE(ring.pop(i));
+    REQUIRE(i == 1);
+
+    // Wrap around, filling the reserved slot in place.
+    int *slot = ring.reserve();
+    REQUIRE(slot != nullptr);
+    *slot = 3;
+    REQUIRE(ring.size() == 1);
+    ring.commit();
+    REQUIRE(ring.size() == 2);
+
+    REQUIRE(ring.pop(i));
+    REQUIRE(i == 2);
+    REQUIRE(ring.pop(i));
+    REQUIRE(i == 3);
+    REQUIRE(ring.size() == 0);
+}
+
+TEST_CASE("spsc ring threads", "[arcus]") {
+    constexpr int count = 100000;
+    SpscRing<int> ring(16);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < count;) {
+            if (ring.push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // Values arrive complete and in order.
+    int expected = 0;
+    while (expected < count) {
+        int i = -1;
+        if (ring.pop(i)) {
+            REQUIRE(i == expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    REQUIRE(ring.size() == 0);
+}
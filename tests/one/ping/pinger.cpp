@@ -3,13 +3,114 @@
 #include <one/ping/internal/pinger.h>
 
 #include <chrono>
+#include <cstring>
 #include <thread>
 
 using namespace i3d::ping;
 
+namespace {
+
+// The reply of a ping site: the data with its first two bytes set to '\0',
+// received after the given round trip.
+Datagram reply(const Datagram &ping,
+               std::chrono::microseconds round_trip = std::chrono::microseconds(0)) {
+    Datagram datagram = ping;
+    datagram.data[0] = '\0';
+    datagram.data[1] = '\0';
+    datagram.time = std::chrono::steady_clock::now() + round_trip;
+    return datagram;
+}
+
+}  // namespace
+
+TEST_CASE("pinger replies", "[pinger]") {
+    Pinger pinger;
+    Datagram ping;
+    REQUIRE(!pinger.prepare_ping(ping));
+
+    REQUIRE(pinger.init(nullptr) == I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR);
+    REQUIRE(pinger.init("213.163.66.54") == I3D_PING_ERROR_NONE);
+    REQUIRE(pinger.init("213.163.66.54") == I3D_PING_ERROR_PINGER_ALREADY_INITIALIZED);
+    REQUIRE(ntohs(pinger.destination().sin_port) == 3075);
+
+    unsigned int count = 0;
+    REQUIRE(pinger.ping_response_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 0);
+
+    // The next ping waits for the interval.
+    REQUIRE(pinger.prepare_ping(ping));
+    REQUIRE(ping.address.sin_addr.s_addr == pinger.destination().sin_addr.s_addr);
+    REQUIRE(ping.size > 2);
+    REQUIRE(!pinger.receive(reply(ping)));  // Not sent yet.
+    pinger.ping_sent();
+    Datagram next;
+    REQUIRE(!pinger.prepare_ping(next));
+
+    // The data must be mirrored.
+    REQUIRE(!pinger.receive(ping));
+    Datagram truncated = reply(ping);
+    truncated.size = 2;
+    REQUIRE(!pinger.receive(truncated));
+    Datagram other = reply(ping);
+    other.data[other.size - 2] = 'x';
+    REQUIRE(!pinger.receive(other));
+
+    // Half the round trip, at least the 10 ms the reply took after now.
+    REQUIRE(pinger.receive(reply(ping, std::chrono::milliseconds(10))));
+    REQUIRE(pinger.ping_response_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 1);
+    int64_t last_us = -1;
+    REQUIRE(pinger.last_time_us(last_us) == I3D_PING_ERROR_NONE);
+    REQUIRE(5000 <= last_us);
+    int last = -1;
+    REQUIRE(pinger.last_time(last) == I3D_PING_ERROR_NONE);
+    REQUIRE(last == last_us / 1000);
+    double median_us = 0.0;
+    REQUIRE(pinger.median_time_us(median_us) == I3D_PING_ERROR_NONE);
+    REQUIRE(median_us == static_cast<double>(last_us));
+
+    // A reply is only handled once.
+    REQUIRE(!pinger.receive(reply(ping)));
+
+    // Several pings in flight, replied in any order.
+    pinger.set_interval(std::chrono::milliseconds(0));
+    Datagram pings[Pinger::max_pings_in_flight];
+    for (auto &datagram : pings) {
+        REQUIRE(pinger.prepare_ping(datagram));
+        pinger.ping_sent();
+    }
+    REQUIRE(!pinger.prepare_ping(next));
+    REQUIRE(std::strcmp(pings[0].data, ping.data) != 0);
+    REQUIRE(std::strcmp(pings[0].data, pings[1].data) != 0);
+
+    REQUIRE(pinger.receive(reply(pings[1])));
+    REQUIRE(pinger.receive(reply(pings[0])));
+    REQUIRE(pinger.ping_response_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 3);
+
+    // A reply after the timeout counts the ping as lost.
+    REQUIRE(pinger.receive(reply(pings[2], std::chrono::seconds(3))));
+    REQUIRE(pinger.ping_response_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 3);
+    REQUIRE(pinger.ping_lost_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 1);
+    REQUIRE(pinger.ping_sent_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 1 + Pinger::max_pings_in_flight);
+
+    // The replied pings make room for the next ones.
+    REQUIRE(pinger.prepare_ping(next));
+    pinger.ping_sent();
+    REQUIRE(pinger.receive(reply(next)));
+    REQUIRE(pinger.ping_response_count(count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 4);
+}
+
 TEST_CASE("pinger statistics", "[pinger]") {
     init_socket_system();
 
+    UdpSocket socket;
+    REQUIRE(socket.init() == I3D_PING_ERROR_NONE);
+
     Pinger pinger;
 
     int last = 0;
@@ -29,34 +130,35 @@ TEST_CASE("pinger statistics", "[pinger]") {
     err = pinger.average_time(average);
     REQUIRE(err == I3D_PING_ERROR_PINGER_INVALID_TIME);
 
-    for (auto i = 0; i < 1000; ++i) {
-        err = pinger.update();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        REQUIRE(err == I3D_PING_ERROR_NONE);
-
-        err = pinger.last_time(last);
-        if (err == I3D_PING_ERROR_NONE) {
-            break;
+    // Pings until the given number of replies are received.
+    const auto ping = [&](unsigned int replies) {
+        unsigned int count = 0;
+        for (auto i = 0; i < 1000 && count < replies; ++i) {
+            Datagram datagram;
+            size_t transferred = 0;
+            if (pinger.prepare_ping(datagram)) {
+                REQUIRE(socket.send(&datagram, 1, transferred) == I3D_PING_ERROR_NONE);
+                if (transferred == 1) {
+                    pinger.ping_sent();
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            REQUIRE(socket.receive(&datagram, 1, transferred) == I3D_PING_ERROR_NONE);
+            if (transferred == 1) {
+                pinger.receive(datagram);
+            }
+            REQUIRE(pinger.ping_response_count(count) == I3D_PING_ERROR_NONE);
         }
-    }
+    };
 
+    ping(1);
     err = pinger.last_time(last);
     REQUIRE(err == I3D_PING_ERROR_NONE);
     err = pinger.average_time(average);
     REQUIRE(err == I3D_PING_ERROR_NONE);
     REQUIRE(last == average);
 
-    for (auto i = 0; i < 1000; ++i) {
-        err = pinger.update();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        REQUIRE(err == I3D_PING_ERROR_NONE);
-
-        err = pinger.last_time(last);
-        if (err == I3D_PING_ERROR_NONE) {
-            break;
-        }
-    }
-
+    ping(2);
     err = pinger.last_time(last);
     REQUIRE(err == I3D_PING_ERROR_NONE);
     err = pinger.average_time(average);
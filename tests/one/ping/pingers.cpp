@@ -4,7 +4,10 @@
 
 #include <one/ping/c_api.h>
 #include <one/ping/error.h>
+#include <one/ping/internal/pinger.h>
+#include <one/ping/pingers.h>
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <iostream>
@@ -184,6 +187,99 @@ TEST_CASE("pingers pinging sites", "[pingers]") {
 }
 
 
+TEST_CASE("pingers statistics snapshot", "[pingers]") {
+    I3dIpListPtr ip_list = nullptr;
+    REQUIRE(i3d_ping_ip_list_create(&ip_list) == I3D_PING_ERROR_NONE);
+    REQUIRE(i3d_ping_ip_list_push_back(ip_list, "127.0.0.1") == I3D_PING_ERROR_NONE);
+    REQUIRE(i3d_ping_ip_list_push_back(ip_list, "127.0.0.2") == I3D_PING_ERROR_NONE);
+
+    I3dPingersPtr pingers = nullptr;
+    REQUIRE(i3d_ping_pingers_create(&pingers, ip_list) == I3D_PING_ERROR_NONE);
+    REQUIRE(i3d_ping_pingers_set_ping_interval(pingers, 0) == I3D_PING_ERROR_NONE);
+
+    I3dPingSiteStatistics statistics[2];
+    unsigned int count = 0;
+    REQUIRE(i3d_ping_pingers_statistics_snapshot(pingers, nullptr, 2, &count) ==
+            I3D_PING_ERROR_VALIDATION_PARAM_IS_NULLPTR);
+    REQUIRE(i3d_ping_pingers_statistics_snapshot(pingers, statistics, 1, &count) ==
+            I3D_PING_ERROR_VALIDATION_BUFFER_IS_TOO_SMALL);
+    REQUIRE(count == 2);
+
+    // Published before the first update, without any time yet.
+    REQUIRE(i3d_ping_pingers_statistics_snapshot(pingers, statistics, 2, &count) ==
+            I3D_PING_ERROR_NONE);
+    REQUIRE(count == 2);
+    REQUIRE(statistics[0].ping_sent_count == 0);
+    REQUIRE(statistics[0].last_time == -1);
+    REQUIRE(statistics[0].jitter == -1.0);
+
+    // Read without locking while the pingers update.
+    std::atomic<bool> is_updating(true);
+    std::atomic<int> failures(0);
+    std::thread reader([&]() {
+        I3dPingSiteStatistics site_statistics[2];
+        unsigned int site_count = 0;
+        while (is_updating) {
+            const auto snapshot_err = i3d_ping_pingers_statistics_snapshot(
+                pingers, site_statistics, 2, &site_count);
+            if (snapshot_err != I3D_PING_ERROR_NONE || site_count != 2) {
+                ++failures;
+            }
+        }
+    });
+    for (auto i = 0; i < 20; ++i) {
+        REQUIRE(i3d_ping_pingers_update(pingers) == I3D_PING_ERROR_NONE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    is_updating = false;
+    reader.join();
+    REQUIRE(failures == 0);
+
+    // An update after the reader is done publishes for sure.
+    REQUIRE(i3d_ping_pingers_update(pingers) == I3D_PING_ERROR_NONE);
+    REQUIRE(i3d_ping_pingers_statistics_snapshot(pingers, statistics, 2, &count) ==
+            I3D_PING_ERROR_NONE);
+    for (const auto &site : statistics) {
+        REQUIRE(0 < site.ping_sent_count);
+        REQUIRE(site.ping_sent_count <= i3d::ping::Pinger::max_pings_in_flight);
+    }
+
+    i3d_ping_pingers_destroy(pingers);
+    i3d_ping_ip_list_destroy(ip_list);
+}
+
+TEST_CASE("pingers statistics snapshot shutdown", "[pingers]") {
+    i3d::ping::IpList ip_list;
+    ip_list.push_back("127.0.0.1");
+    ip_list.push_back("127.0.0.2");
+
+    // Shutting down while a reader visits the snapshots, which are then empty.
+    for (auto i = 0; i < 10; ++i) {
+        i3d::ping::Pingers pingers;
+        REQUIRE(pingers.init(ip_list) == I3D_PING_ERROR_NONE);
+        REQUIRE(pingers.update() == I3D_PING_ERROR_NONE);
+
+        std::atomic<bool> is_reading(true);
+        std::atomic<int> failures(0);
+        const auto visit = [](size_t, const i3d::ping::Pingers::Statistics &) {};
+        std::thread reader([&]() {
+            while (is_reading) {
+                const size_t count = pingers.visit_snapshot(visit);
+                if (count != 0 && count != 2) {
+                    ++failures;
+                }
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pingers.shutdown();
+
+        REQUIRE(pingers.visit_snapshot(visit) == 0);
+        is_reading = false;
+        reader.join();
+        REQUIRE(failures == 0);
+    }
+}
+
 TEST_CASE("ping sites using json callback to test payload size bigger than c_api buffers",
           "[sites_getter]") {
     I3dSitesGetterPtr sites_getter = nullptr;
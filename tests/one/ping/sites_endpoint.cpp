@@ -1,10 +1,12 @@
 #include <catch.hpp>
 
+#include <one/ping/allocator.h>
 #include <one/ping/error.h>
 #include <one/ping/internal/sites_endpoint.h>
 #include <one/ping/internal/site_information.h>
 #include <one/ping/types.h>
 
+#include <cstdlib>
 #include <string>
 
 using namespace i3d::ping;
@@ -269,3 +271,40 @@ TEST_CASE("ping site endpoint parse invalid payload", "[ping site endpoint]") {
 
     REQUIRE(sites.size() == 0);
 }
+
+TEST_CASE("ping site endpoint parse allocations", "[ping site endpoint]") {
+    static size_t alloc_count = 0;
+    static size_t free_count = 0;
+    static size_t realloc_count = 0;
+    alloc_count = free_count = realloc_count = 0;
+    allocator::set_alloc([](size_t bytes) -> void * {
+        alloc_count++;
+        return std::malloc(bytes);
+    });
+    allocator::set_free([](void *p) {
+        if (p != nullptr) free_count++;
+        std::free(p);
+    });
+    allocator::set_realloc([](void *, size_t) -> void * {
+        realloc_count++;
+        return nullptr;
+    });
+
+    // The JSON document memory goes through the alloc and free overrides.
+    {
+        std::string json =
+            "[{\"continentId\": 5, \"country\": \"Netherlands\", \"dcLocationId\": 6, "
+            "\"dcLocationName\": \"i3d-eu-west-1\", \"hostname\": "
+            "\"nlrtm1-pingbeacon1.sys.i3d.network\", \"ipv4\": [\"213.163.66.59\"], "
+            "\"ipv6\": []}]";
+        Vector<SiteInformation> sites;
+        SitesEndpoint endpoint;
+        REQUIRE(endpoint.parse_payload(json.c_str(), sites) == I3D_PING_ERROR_NONE);
+        REQUIRE(sites.size() == 1);
+    }
+    allocator::reset_overrides();
+
+    REQUIRE(alloc_count > 0);
+    REQUIRE(alloc_count == free_count);
+    REQUIRE(realloc_count == 0);
+}
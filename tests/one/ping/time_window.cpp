@@ -0,0 +1,103 @@
+#include <catch.hpp>
+
+#include <one/ping/internal/time_window.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace i3d::ping;
+
+TEST_CASE("time window statistics", "[time window]") {
+    TimeWindow window;
+    REQUIRE(window.size() == TimeWindow::default_size);
+
+    double median = 0.0;
+    int64_t sample = 0;
+    double jitter = 0.0;
+    REQUIRE(window.median(median) == I3D_PING_ERROR_PINGER_INVALID_TIME);
+    REQUIRE(window.percentile(50.0, sample) == I3D_PING_ERROR_PINGER_INVALID_TIME);
+    REQUIRE(window.jitter(jitter) == I3D_PING_ERROR_PINGER_INVALID_TIME);
+
+    window.push(30);
+    REQUIRE(window.median(median) == I3D_PING_ERROR_NONE);
+    REQUIRE(median == 30.0);
+    REQUIRE(window.jitter(jitter) == I3D_PING_ERROR_PINGER_INVALID_TIME);
+
+    window.push(10);
+    window.push(20);
+    window.push(40);
+    REQUIRE(window.count() == 4);
+    REQUIRE(window.median(median) == I3D_PING_ERROR_NONE);
+    REQUIRE(median == 25.0);
+    REQUIRE(window.percentile(50.0, sample) == I3D_PING_ERROR_NONE);
+    REQUIRE(sample == 20);
+    REQUIRE(window.percentile(90.0, sample) == I3D_PING_ERROR_NONE);
+    REQUIRE(sample == 40);
+    REQUIRE(window.percentile(1.0, sample) == I3D_PING_ERROR_NONE);
+    REQUIRE(sample == 10);
+    REQUIRE(window.percentile(0.0, sample) == I3D_PING_ERROR_PINGER_INVALID_PERCENTILE);
+    REQUIRE(window.percentile(101.0, sample) ==
+            I3D_PING_ERROR_PINGER_INVALID_PERCENTILE);
+
+    // |10 - 30| + |20 - 10| + |40 - 20| over 3.
+    REQUIRE(window.jitter(jitter) == I3D_PING_ERROR_NONE);
+    REQUIRE(jitter == Approx(50.0 / 3.0));
+
+    window.clear();
+    REQUIRE(window.count() == 0);
+    REQUIRE(window.median(median) == I3D_PING_ERROR_PINGER_INVALID_TIME);
+}
+
+TEST_CASE("time window rolling", "[time window]") {
+    TimeWindow window;
+    REQUIRE(window.set_size(0) == I3D_PING_ERROR_PINGER_INVALID_HISTORY_SIZE);
+    REQUIRE(window.set_size(TimeWindow::max_size + 1) ==
+            I3D_PING_ERROR_PINGER_INVALID_HISTORY_SIZE);
+    REQUIRE(window.set_size(5) == I3D_PING_ERROR_NONE);
+
+    // The statistics must match those of the last samples, sorted.
+    std::vector<int64_t> samples;
+    int64_t value = 7;
+    for (int i = 0; i < 50; ++i) {
+        value = (value * 31 + 11) % 97;
+        samples.push_back(value);
+        window.push(value);
+
+        const size_t count = std::min(samples.size(), size_t(5));
+        REQUIRE(window.count() == count);
+        std::vector<int64_t> last(samples.end() - count, samples.end());
+
+        double jitter_total = 0.0;
+        for (size_t j = 1; j < last.size(); ++j) {
+            jitter_total += static_cast<double>(std::max(last[j], last[j - 1]) -
+                                                std::min(last[j], last[j - 1]));
+        }
+        double jitter = 0.0;
+        if (1 < count) {
+            REQUIRE(window.jitter(jitter) == I3D_PING_ERROR_NONE);
+            REQUIRE(jitter == Approx(jitter_total / (count - 1)));
+        }
+
+        std::sort(last.begin(), last.end());
+        int64_t sample = 0;
+        REQUIRE(window.percentile(100.0, sample) == I3D_PING_ERROR_NONE);
+        REQUIRE(sample == last.back());
+        REQUIRE(window.percentile(20.0, sample) == I3D_PING_ERROR_NONE);
+        REQUIRE(sample == last.front());
+    }
+
+    // Shrinking keeps the most recent samples.
+    REQUIRE(window.set_size(2) == I3D_PING_ERROR_NONE);
+    REQUIRE(window.count() == 2);
+    double median = 0.0;
+    REQUIRE(window.median(median) == I3D_PING_ERROR_NONE);
+    REQUIRE(median == (samples[48] + samples[49]) / 2.0);
+
+    // Growing keeps all of them.
+    REQUIRE(window.set_size(TimeWindow::max_size) == I3D_PING_ERROR_NONE);
+    REQUIRE(window.count() == 2);
+    window.push(1000);
+    int64_t sample = 0;
+    REQUIRE(window.percentile(100.0, sample) == I3D_PING_ERROR_NONE);
+    REQUIRE(sample == 1000);
+}
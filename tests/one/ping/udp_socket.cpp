@@ -1,126 +1,137 @@
 #include <catch.hpp>
 
 #include <one/ping/c_platform.h>
+#include <one/ping/internal/pinger.h>
 #include <one/ping/internal/udp_socket.h>
 #include <one/ping/c_error.h>
 
 #include <chrono>
+#include <cstring>
 #include <thread>
 
 using namespace i3d::ping;
 
-TEST_CASE("udp socket life cycle", "[icmp socket]") {
-#ifdef I3D_PING_WINDOWS
+TEST_CASE("udp socket life cycle", "[udp socket]") {
     init_socket_system();
-    UdpSocket socket;
-    auto err = socket.init("213.163.66.54", 3075);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
 
-    shutdown_socket_system();
-#else
     UdpSocket socket;
-    auto err = socket.init("213.163.66.54", 3075);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
-#endif
-}
+    REQUIRE(!socket.is_initialized());
 
-TEST_CASE("ping host", "[icmp socket]") {
-    init_socket_system();
+    Datagram datagram{};
+    size_t count = 0;
+    REQUIRE(socket.send(&datagram, 1, count) == I3D_PING_ERROR_SOCKET_NOT_INITIALIZED);
+    REQUIRE(socket.receive(&datagram, 1, count) == I3D_PING_ERROR_SOCKET_NOT_INITIALIZED);
 
-    UdpSocket socket;
-    int time = 0;
+    REQUIRE(socket.init() == I3D_PING_ERROR_NONE);
+    REQUIRE(socket.is_initialized());
+    REQUIRE(socket.init() == I3D_PING_ERROR_SOCKET_ALREADY_INITIALIZED);
 
-    auto err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_SOCKET_INVALID_TIME);
+    // Nothing pending, the receive doesn't wait.
+    REQUIRE(socket.receive(&datagram, 1, count) == I3D_PING_ERROR_NONE);
+    REQUIRE(count == 0);
 
-    err = socket.init("213.163.66.54", 3075);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
-    err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_SOCKET_INVALID_TIME);
+    socket.close();
+    REQUIRE(!socket.is_initialized());
 
-    for (auto i = 0; i < 100; ++i) {
-        err = socket.update();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        REQUIRE(err == I3D_PING_ERROR_NONE);
+    sockaddr_in address{};
+    REQUIRE(UdpSocket::address("213.163.66.54", 3075, address) == I3D_PING_ERROR_NONE);
+    REQUIRE(ntohs(address.sin_port) == 3075);
+    REQUIRE(UdpSocket::address("213.163.660.54", 3075, address) ==
+            I3D_PING_ERROR_SOCKET_INVALID_IPV4);
 
-        err = socket.time_milliseconds(time);
+    shutdown_socket_system();
+}
 
-        if (err == I3D_PING_ERROR_SOCKET_INVALID_TIME) {
-            continue;
-        }
+#ifndef I3D_PING_WINDOWS
+TEST_CASE("udp socket batches", "[udp socket]") {
+    // A local endpoint mirroring the datagrams like the ping sites.
+    const int mirror = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    REQUIRE(mirror >= 0);
+    sockaddr_in mirror_address{};
+    mirror_address.sin_family = AF_INET;
+    mirror_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(::bind(mirror, (sockaddr *)&mirror_address, sizeof(mirror_address)) == 0);
+    socklen_t length = sizeof(mirror_address);
+    REQUIRE(::getsockname(mirror, (sockaddr *)&mirror_address, &length) == 0);
 
-        if (err == I3D_PING_ERROR_NONE) {
-            break;
-        }
+    UdpSocket socket;
+    REQUIRE(socket.init() == I3D_PING_ERROR_NONE);
+
+    // All sent by a single call.
+    constexpr size_t count = 3;
+    Datagram datagrams[count];
+    for (size_t i = 0; i < count; ++i) {
+        datagrams[i].address = mirror_address;
+        datagrams[i].size = 4;
+        std::memcpy(datagrams[i].data, "abc", 4);
+        datagrams[i].data[2] = static_cast<char>('0' + i);
+    }
+    size_t sent = 0;
+    REQUIRE(socket.send(datagrams, count, sent) == I3D_PING_ERROR_NONE);
+    REQUIRE(sent == count);
+
+    for (size_t i = 0; i < count; ++i) {
+        char data[Datagram::max_size];
+        sockaddr_in source{};
+        socklen_t source_length = sizeof(source);
+        const auto size = ::recvfrom(mirror, data, sizeof(data), 0, (sockaddr *)&source,
+                                     &source_length);
+        REQUIRE(size == 4);
+        data[0] = '\0';
+        data[1] = '\0';
+        REQUIRE(::sendto(mirror, data, size, 0, (sockaddr *)&source, source_length) ==
+                size);
     }
 
-    err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
+    // All received, possibly over a few calls while they arrive.
+    Datagram replies[count + 1];
+    size_t received = 0;
+    for (int i = 0; i < 100 && received < count; ++i) {
+        size_t batch = 0;
+        REQUIRE(socket.receive(replies + received, count + 1 - received, batch) ==
+                I3D_PING_ERROR_NONE);
+        received += batch;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(received == count);
+    for (size_t i = 0; i < count; ++i) {
+        REQUIRE(replies[i].address.sin_port == mirror_address.sin_port);
+        REQUIRE(replies[i].size == 4);
+        REQUIRE(replies[i].data[2] == static_cast<char>('0' + i));
+    }
 
-    shutdown_socket_system();
+    ::close(mirror);
 }
+#endif
 
-TEST_CASE("udp reset", "[icmp socket]") {
+TEST_CASE("ping host", "[udp socket]") {
     init_socket_system();
 
     UdpSocket socket;
-    int time = 0;
-
-    auto err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_SOCKET_INVALID_TIME);
+    REQUIRE(socket.init() == I3D_PING_ERROR_NONE);
 
-    err = socket.init("213.163.66.54", 3075);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
-    err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_SOCKET_INVALID_TIME);
+    Pinger pinger;
+    REQUIRE(pinger.init("213.163.66.54") == I3D_PING_ERROR_NONE);
 
+    int time = 0;
     for (auto i = 0; i < 100; ++i) {
-        err = socket.update();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        REQUIRE(err == I3D_PING_ERROR_NONE);
-
-        err = socket.time_milliseconds(time);
-
-        if (err == I3D_PING_ERROR_SOCKET_INVALID_TIME) {
-            continue;
+        Datagram datagram;
+        size_t count = 0;
+        if (pinger.prepare_ping(datagram)) {
+            REQUIRE(socket.send(&datagram, 1, count) == I3D_PING_ERROR_NONE);
+            if (count == 1) {
+                pinger.ping_sent();
+            }
         }
 
-        if (err == I3D_PING_ERROR_NONE) {
-            break;
-        }
-    }
-
-    REQUIRE(socket.status() == UdpSocket::Status::ping_received);
-    err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
-
-    err = socket.update();
-    REQUIRE(err == I3D_PING_ERROR_NONE);
-    auto s = socket.status();
-    REQUIRE(socket.status() == UdpSocket::Status::initialized);
-    err = socket.time_milliseconds(time);
-
-    REQUIRE(err == I3D_PING_ERROR_SOCKET_INVALID_TIME);
-
-    for (auto i = 0; i < 100; ++i) {
-        err = socket.update();
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        REQUIRE(err == I3D_PING_ERROR_NONE);
-        auto s = socket.status();
-
-        err = socket.time_milliseconds(time);
-
-        if (err == I3D_PING_ERROR_SOCKET_INVALID_TIME) {
-            continue;
-        }
-
-        if (err == I3D_PING_ERROR_NONE) {
+        REQUIRE(socket.receive(&datagram, 1, count) == I3D_PING_ERROR_NONE);
+        if (count == 1 && pinger.receive(datagram)) {
             break;
         }
     }
 
-    err = socket.time_milliseconds(time);
-    REQUIRE(err == I3D_PING_ERROR_NONE);
+    REQUIRE(pinger.last_time(time) == I3D_PING_ERROR_NONE);
 
     shutdown_socket_system();
 }